@@ -26,7 +26,10 @@ enum class BandControl
     Ratio,
     Bypass,
     Solo,
-    Mute
+    Mute,
+    Detector,
+    RMS_Window,
+    Mode
 };
 
 static std::map<BandControl, juce::String> bandControlMap =
@@ -38,7 +41,10 @@ static std::map<BandControl, juce::String> bandControlMap =
     { BandControl::Ratio,     "Ratio" },
     { BandControl::Bypass,    "Bypass" },
     { BandControl::Solo,      "Solo" },
-    { BandControl::Mute,      "Mute" }
+    { BandControl::Mute,      "Mute" },
+    { BandControl::Detector,  "Detector" },
+    { BandControl::RMS_Window, "RMS Window" },
+    { BandControl::Mode,      "Mode" }
 };
 
 inline juce::String getBandControlParamName(BandControl bandControl, const int& bandNum)
@@ -66,7 +72,9 @@ enum class Names
     Gain_In,
     Gain_Out,
     Selected_Band,
-    Number_Of_Bands
+    Number_Of_Bands,
+    Control_Rate_Detection,
+    Input_Loudness
 };
 
 inline const std::map<Names, juce::String>& getParams()
@@ -77,7 +85,9 @@ inline const std::map<Names, juce::String>& getParams()
         { Names::Gain_In, "Gain In" },
         { Names::Gain_Out, "Gain Out" },
         { Names::Selected_Band, "Selected Band" },
-        { Names::Number_Of_Bands, "Number Of Bands" }
+        { Names::Number_Of_Bands, "Number Of Bands" },
+        { Names::Control_Rate_Detection, "Control Rate Detection" },
+        { Names::Input_Loudness, "Input Loudness" }
     };
     
     return params;
@@ -106,4 +116,57 @@ inline const std::map<ProcessingMode, juce::String>& getProcessingModes()
     return modes;
 }
 
+// Global follows the Processing Mode parameter, the rest line up with ProcessingMode so it can be resolved by index
+enum class BandProcessingMode
+{
+    Global,
+    Stereo,
+    Left,
+    Right,
+    Mid,
+    Side,
+    Linked
+};
+
+inline const std::map<BandProcessingMode, juce::String>& getBandProcessingModes()
+{
+    static std::map<BandProcessingMode, juce::String> modes =
+    {
+        { BandProcessingMode::Global,    "Global" },
+        { BandProcessingMode::Stereo,    "Stereo" },
+        { BandProcessingMode::Left,      "Left" },
+        { BandProcessingMode::Right,     "Right" },
+        { BandProcessingMode::Mid,       "Mid" },
+        { BandProcessingMode::Side,      "Side" },
+        { BandProcessingMode::Linked,    "Linked" }
+    };
+    
+    return modes;
+}
+
+inline BandProcessingMode resolveBandProcessingMode(BandProcessingMode bandMode, ProcessingMode globalMode)
+{
+    if ( bandMode != BandProcessingMode::Global )
+        return bandMode;
+    
+    return static_cast<BandProcessingMode>(static_cast<int>(globalMode) + 1);
+}
+
+enum class DetectorMode
+{
+    Peak,
+    RMS
+};
+
+inline const std::map<DetectorMode, juce::String>& getDetectorModes()
+{
+    static std::map<DetectorMode, juce::String> modes =
+    {
+        { DetectorMode::Peak, "Peak" },
+        { DetectorMode::RMS,  "RMS" }
+    };
+    
+    return modes;
+}
+
 }
@@ -88,6 +88,9 @@ void ControlPlaceholder::resetCompressors()
         resetHelper(Params::getBandControlParamName(Params::BandControl::Threshold, i));
         resetHelper(Params::getBandControlParamName(Params::BandControl::Gain,      i));
         resetHelper(Params::getBandControlParamName(Params::BandControl::Ratio,     i));
+        resetHelper(Params::getBandControlParamName(Params::BandControl::Detector,  i));
+        resetHelper(Params::getBandControlParamName(Params::BandControl::RMS_Window, i));
+        resetHelper(Params::getBandControlParamName(Params::BandControl::Mode,      i));
     }
 }
 
@@ -95,7 +98,7 @@ void ControlPlaceholder::resetCompressors()
 PFMProject12AudioProcessorEditor::PFMProject12AudioProcessorEditor (PFMProject12AudioProcessor& p)
 : AudioProcessorEditor (&p),
   audioProcessor (p),
-  spectrumAnalyzer(audioProcessor.getSampleRate(), audioProcessor.leftSCSF, audioProcessor.rightSCSF, audioProcessor.apvts),
+  spectrumAnalyzer(audioProcessor.getSampleRate(), audioProcessor.analysisRing, audioProcessor.apvts),
   analyzerControls(audioProcessor.apvts),
   modeSelector(audioProcessor.apvts),
   gainInRotary(audioProcessor.apvts, Params::Names::Gain_In),
@@ -122,6 +125,8 @@ PFMProject12AudioProcessorEditor::PFMProject12AudioProcessorEditor (PFMProject12
     auto nBands = numBandsParam->convertFrom0to1(numBandsParam->getValue());
     bandCountPicker.setSelectedId(nBands);
     
+    inStereoMeter.onLoudnessReset = outStereoMeter.onLoudnessReset = [this]() { audioProcessor.resetLoudness(); };
+    
     addAndMakeVisible(inStereoMeter);
     addAndMakeVisible(outStereoMeter);
     addAndMakeVisible(bandControls);
@@ -217,21 +222,20 @@ void PFMProject12AudioProcessorEditor::resized()
 
 void PFMProject12AudioProcessorEditor::timerCallback()
 {
-    handleMeterFifo(audioProcessor.inMeterValuesFifo, inMeterValues, inStereoMeter);
-    handleMeterFifo(audioProcessor.outMeterValuesFifo, outMeterValues, outStereoMeter);
-    
-    auto& compressors = audioProcessor.getCompressors();
-    std::array<BandLevel, Globals::getNumMaxBands()> levels;
+    // every block since the last frame is looked at, so peaks that came and went in between still show up
+    MeterSnapshot meterSnapshot;
+    auto numSnapshots = audioProcessor.meterHistory.readSince(meterReadPosition, [&meterSnapshot, first = true](const MeterSnapshot& snapshot) mutable
+    {
+        meterSnapshot = first ? snapshot : MeterSnapshot::combine(meterSnapshot, snapshot);
+        first = false;
+    });
     
-    for ( auto i = 0; i < Globals::getNumMaxBands(); ++i )
+    if ( numSnapshots > 0 )
     {
-        BandLevel bandLevel;
-        bandLevel.rmsInputLevelDb = compressors[i].getRMSInputLevelDb();
-        bandLevel.rmsOutputLevelDb = compressors[i].getRMSOutputLevelDb();
-        levels.at(i) = bandLevel;
+        inStereoMeter.update(meterSnapshot.in);
+        outStereoMeter.update(meterSnapshot.out);
+        compSelectionControls.updateMeters(meterSnapshot.bands);
     }
-
-    compSelectionControls.updateMeters(levels);
     
     auto nFilterBands = audioProcessor.numFilterBands.load();
     if ( nFilterBands != numActiveFilterBands )
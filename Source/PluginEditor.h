@@ -51,23 +51,13 @@ public:
     
     void timerCallback() override;
     
-    template<typename FifoType>
-    void handleMeterFifo(FifoType& fifo, MeterValues& meterValues, StereoMeter& stereoMeter)
-    {
-        if ( fifo.getNumAvailableForReading() > 0 )
-        {
-            while ( fifo.pull(meterValues) ) { }
-            stereoMeter.update(meterValues);
-        }
-    }
-
 private:
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
     PFMProject12AudioProcessor& audioProcessor;
     
 //    juce::AudioBuffer<float> buffer;
-    MeterValues inMeterValues, outMeterValues;
+    juce::uint64 meterReadPosition { 0 };
     
     StereoMeter inStereoMeter, outStereoMeter;
     
@@ -35,10 +35,11 @@ void InvertedNetwork::updateCutoffs(std::vector<float> xoverFreqs)
 
 const juce::AudioBuffer<float>& InvertedNetwork::getProcessedBuffer() { return buffer; }
 
-void InvertedNetwork::process(const juce::AudioBuffer<float>& inputBuffer)
+void InvertedNetwork::process(const juce::dsp::AudioBlock<float>& input)
 {
-    buffer = inputBuffer;
+    buffer.setSize(static_cast<int>(input.getNumChannels()), static_cast<int>(input.getNumSamples()), false, false, true);
     auto block = juce::dsp::AudioBlock<float>(buffer);
+    block.copyFrom(input);
     auto context = juce::dsp::ProcessContextReplacing<float>(block);
     for ( auto& filter : allpassFilters )
     {
@@ -75,6 +76,7 @@ void InvertedNetwork::prepareInternal()
 //==============================================================================
 void CompressorBand::prepare(juce::dsp::ProcessSpec& spec)
 {
+    sampleRate = spec.sampleRate;
     compressor.prepare(spec);
     gain.prepare(spec);
     gain.setRampDurationSeconds(0.05); // 50ms
@@ -86,6 +88,11 @@ void CompressorBand::updateCompressor()
     compressor.setRelease(release != nullptr ? release->get() : 250.f);
     compressor.setThreshold(threshold != nullptr ? threshold->get() : 0.f);
     compressor.setRatio(ratio != nullptr ? ratio->getCurrentChoiceName().getFloatValue() : 3.f);
+    compressor.setRMSWindow(rmsWindow != nullptr ? rmsWindow->get() : 50.f);
+    
+    auto detectorMode = static_cast<Params::DetectorMode>(detector != nullptr ? detector->getIndex() : 0);
+    compressor.setDetector(detectorMode == Params::DetectorMode::RMS ? BandCompressor<float>::Detector::RMS
+                                                                     : BandCompressor<float>::Detector::Peak);
     
     compressorConfigured = true;
 }
@@ -102,48 +109,93 @@ void CompressorBand::updateBypassState()
     shouldBeBypassed = (bypassed != nullptr ? bypassed->get() : false);
 }
 
-void CompressorBand::process(juce::AudioBuffer<float>& buffer)
+void CompressorBand::updateControlRate(bool controlRateEnabled, float bandUpperEdgeHz)
+{
+    if ( !controlRateEnabled )
+    {
+        compressor.setControlRateInterval(1);
+        return;
+    }
+    
+    auto attackMs = attack != nullptr ? attack->get() : 50.f;
+    compressor.setControlRateInterval(BandCompressor<float>::getControlRateIntervalFor(sampleRate, bandUpperEdgeHz, attackMs));
+}
+
+void CompressorBand::setStereoLinked(bool shouldBeLinked)
+{
+    compressor.setStereoLinked(shouldBeLinked);
+}
+
+void CompressorBand::setMeteringEnabled(bool shouldBeEnabled)
+{
+    if ( shouldBeEnabled == meteringEnabled )
+        return;
+    
+    meteringEnabled = shouldBeEnabled;
+    
+    // nothing updates the levels while metering is off, so don't leave the last ones showing
+    if ( !meteringEnabled )
+        levels = BandLevel();
+}
+
+Params::BandProcessingMode CompressorBand::getProcessingMode(Params::ProcessingMode globalMode) const
+{
+    auto mode = static_cast<Params::BandProcessingMode>(bandMode != nullptr ? bandMode->getIndex() : 0);
+    return Params::resolveBandProcessingMode(mode, globalMode);
+}
+
+void CompressorBand::process(juce::dsp::AudioBlock<float>& block)
 {
     jassert(compressorConfigured);
     jassert(gainConfigured);
     
-    rmsInputLevelDb.store(juce::Decibels::gainToDecibels(computeRMSLevel(buffer), Globals::getNegativeInf()));
-    
-    auto block = juce::dsp::AudioBlock<float>(buffer);
     auto context = juce::dsp::ProcessContextReplacing<float>(block);
     
     context.isBypassed = shouldBeBypassed;
     
     compressor.process(context);
-    gain.process(context);
+    
+    // at 0dB of makeup gain the gain stage would only multiply everything by 1
+    if ( gain.isSmoothing() || gain.getGainLinear() != 1.f )
+    {
+        gain.process(context);
+    }
     
     compressorConfigured = false;
     gainConfigured = false;
     
-    rmsOutputLevelDb.store(juce::Decibels::gainToDecibels(computeRMSLevel(buffer), Globals::getNegativeInf()));
-}
-
-float CompressorBand::getRMSInputLevelDb()
-{
-    return rmsInputLevelDb.load();
+    if ( meteringEnabled )
+        updateLevels();
 }
 
-float CompressorBand::getRMSOutputLevelDb()
+/*
+The compressor measured its input and output while processing, so the band's levels cost no extra passes.
+The makeup gain is applied on top of the compressor's output levels (at its target value while it's still ramping).
+*/
+void CompressorBand::updateLevels()
 {
-    return rmsOutputLevelDb.load();
+    const auto& stats = compressor.getStatistics();
+    auto makeup = shouldBeBypassed ? 1.f : gain.getGainLinear();
+    
+    std::array<float, 6> values
+    {
+        stats.input.peak,
+        stats.getInputRMS(),
+        stats.output.peak * makeup,
+        stats.getOutputRMS() * makeup,
+        stats.minGain,
+        stats.getMeanGain()
+    };
+    
+    Decibel<float>::gainsToDecibels(values.data(), values.data(), static_cast<int>(values.size()), Globals::getNegativeInf());
+    
+    levels = { values[0], values[1], values[2], values[3], values[4], values[5] };
 }
 
 //==============================================================================
 PFMProject12AudioProcessor::PFMProject12AudioProcessor()
 #ifndef JucePlugin_PreferredChannelConfigurations
-     : AudioProcessor (BusesProperties()
-                     #if ! JucePlugin_IsMidiEffect
-                      #if ! JucePlugin_IsSynth
-                       .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
-                      #endif
-                       .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
-                     #endif
-                       )
+     : AudioProcessor (createBusesProperties())
 #endif
 {
     auto assignFloatParam = [&apvts = this->apvts](auto& target, const auto& name)
@@ -184,6 +236,9 @@ PFMProject12AudioProcessor::PFMProject12AudioProcessor()
         assignBoolParam   (compressors[i].bypassed,   Params::getBandControlParamName(Params::BandControl::Bypass, i));
         assignBoolParam   (compressors[i].solo,       Params::getBandControlParamName(Params::BandControl::Solo, i));
         assignBoolParam   (compressors[i].mute,       Params::getBandControlParamName(Params::BandControl::Mute, i));
+        assignChoiceParam (compressors[i].detector,   Params::getBandControlParamName(Params::BandControl::Detector, i));
+        assignFloatParam  (compressors[i].rmsWindow,  Params::getBandControlParamName(Params::BandControl::RMS_Window, i));
+        assignChoiceParam (compressors[i].bandMode,   Params::getBandControlParamName(Params::BandControl::Mode, i));
     }
     
     const auto& params = Params::getParams();
@@ -193,6 +248,8 @@ PFMProject12AudioProcessor::PFMProject12AudioProcessor()
     assignFloatParam(gainIn, params.at(Params::Names::Gain_In));
     assignFloatParam(gainOut, params.at(Params::Names::Gain_Out));
     assignIntParam(selectedBand, params.at(Params::Names::Selected_Band));
+    assignBoolParam(controlRateDetection, params.at(Params::Names::Control_Rate_Detection));
+    assignBoolParam(inputLoudnessEnabled, params.at(Params::Names::Input_Loudness));
     
     defaultCenterFrequenciesUpdater = std::make_unique<FifoBackgroundUpdater<int>>([this](const int& nBands){ updateDefaultCenterFrequencies(nBands); });
     
@@ -282,30 +339,29 @@ void PFMProject12AudioProcessor::prepareToPlay (double sampleRate, int samplesPe
 {
     spec.sampleRate = sampleRate;
     spec.maximumBlockSize = samplesPerBlock;
-    spec.numChannels = getTotalNumOutputChannels();
+    spec.numChannels = getMainBusNumOutputChannels();
         
     for ( auto& comp : compressors )
     {
         comp.prepare(spec);
     }
     
-    for ( auto& lmBuffer : leftMidBuffers )
-    {
-        lmBuffer.setSize(getTotalNumOutputChannels(), samplesPerBlock, false, true, true);
-        lmBuffer.clear();
-    }
-    
-    for ( auto& rsBuffer : rightSideBuffers )
-    {
-        rsBuffer.setSize(getTotalNumOutputChannels(), samplesPerBlock, false, true, true);
-        rsBuffer.clear();
-    }
-    
     inputGain.prepare(spec);
     outputGain.prepare(spec);
+    inputMeter.prepare(spec);
+    outputMeter.prepare(spec);
+    preAnalyzerTap.prepare(spec);
+    postAnalyzerTap.prepare(spec);
+    inputLoudness.prepare(spec);
+    outputLoudness.prepare(spec);
+    
+    // the crossovers need the new rate and their buffers the new block size
+    if ( activeFilterSequence != nullptr )
+        activeFilterSequence->prepare(spec);
     
-    leftSCSF.prepare(samplesPerBlock);
-    rightSCSF.prepare(samplesPerBlock);
+    meterSnapshot.samplePosition = 0;
+    
+    analysisRing.prepare(2, sampleRate, samplesPerBlock);
     
 #if USE_TEST_OSC
     testOsc.prepare(spec);
@@ -352,13 +408,21 @@ bool PFMProject12AudioProcessor::isBusesLayoutSupported (const BusesLayout& layo
     if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
         return false;
    #endif
+   
+    // the band outputs are either off or carry the same channels as the main output
+    for ( auto bus = 1; bus < layouts.outputBuses.size(); ++bus )
+    {
+        const auto& bandOutput = layouts.getChannelSet(false, bus);
+        if ( !bandOutput.isDisabled() && bandOutput != layouts.getMainOutputChannelSet() )
+            return false;
+    }
 
     return true;
   #endif
 }
 #endif
 
-void PFMProject12AudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+void PFMProject12AudioProcessor::processBlock (juce::AudioBuffer<float>& hostBuffer, juce::MidiBuffer& midiMessages)
 {
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels  = getTotalNumInputChannels();
@@ -371,7 +435,10 @@ void PFMProject12AudioProcessor::processBlock (juce::AudioBuffer<float>& buffer,
     // when they first compile a plugin, but obviously you don't need to keep
     // this code if your algorithm always overwrites all the output channels.
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
-        buffer.clear (i, 0, buffer.getNumSamples());
+        hostBuffer.clear (i, 0, hostBuffer.getNumSamples());
+    
+    // everything but the band outputs works on the main bus
+    auto buffer = getBusBuffer(hostBuffer, false, 0);
     
     updateBands();
     
@@ -380,82 +447,98 @@ void PFMProject12AudioProcessor::processBlock (juce::AudioBuffer<float>& buffer,
     invertedNetwork.updateCutoffs( getDefaultCenterFrequencies(currentNumberOfBands) );
 #endif
     
-    applyGain(buffer, inputGain);
+    /*
+    While the host renders offline nobody is watching the analyzer or the meters, so they're switched off.
+    They only read the audio, so switching them doesn't touch the output.
+    
+    The crossovers deliberately stay the same offline. Steeper or linear-phase ones would make a bounce sound
+    different from what was heard during playback, and cascading the Linkwitz-Riley sections doesn't sum flat.
+    There's no larger internal batching either: the chain already works on whole host blocks.
+    */
+    auto offline = isNonRealtime();
+    auto analyzerOn = onOffParam->get() && !offline;
+    auto analyzerPoint = prePostParam->getCurrentChoiceName();
+    preAnalyzerTap.setEnabled(analyzerOn && analyzerPoint == preStr);
+    postAnalyzerTap.setEnabled(analyzerOn && analyzerPoint == postStr);
+    inputMeter.setEnabled(!offline);
+    outputMeter.setEnabled(!offline);
+    inputLoudness.setEnabled(!offline && inputLoudnessEnabled->get());
+    outputLoudness.setEnabled(!offline);
     
-    if (onOffParam->get() && prePostParam->getCurrentChoiceName() == preStr)
+    for ( auto& comp : compressors )
     {
-        leftSCSF.update(buffer);
-        rightSCSF.update(buffer);
+        comp.setMeteringEnabled(!offline);
     }
-
-    updateMeterFifos(inMeterValuesFifo, buffer);
     
-    activeFilterSequence->process(buffer);
+    /*
+    Everything in the chain is sized for the block size promised in prepareToPlay().
+    A host that sends more than that gets it processed in runs of at most that many samples.
+    */
+    auto hostBlock = juce::dsp::AudioBlock<float>(hostBuffer);
+    auto block = juce::dsp::AudioBlock<float>(buffer);
+    const auto maxRunLength = static_cast<size_t>(spec.maximumBlockSize);
     
-#if TEST_FILTER_NETWORK
-    invertedNetwork.process(buffer);
-#endif
+    for ( size_t start = 0; start < block.getNumSamples(); start += maxRunLength )
+    {
+        auto runLength = juce::jmin(maxRunLength, block.getNumSamples() - start);
+        routeBandOutputs(hostBlock.getSubBlock(start, runLength));
+        
+        auto run = block.getSubBlock(start, runLength);
+        chain.process(run);
+    }
     
-    auto mode = processingMode->getIndex();
+    meterSnapshot.samplePosition += buffer.getNumSamples();
     
-    for ( auto i = 0; i < currentNumberOfBands; ++i )
+    if ( !offline )
     {
-        auto& source = activeFilterSequence->getFilteredBuffer(i);
-        const auto& sourceNumSamples = source.getNumSamples();
-        
-        switch (mode)
+        for ( size_t i = 0; i < compressors.size(); ++i )
         {
-            case static_cast<int>(Params::ProcessingMode::Stereo):
-            {
-                compressors[i].process(source);
-                break;
-            }
-            case static_cast<int>(Params::ProcessingMode::Left):
-            case static_cast<int>(Params::ProcessingMode::Right):
-            {
-                leftMidBuffers[i].clear();
-                rightSideBuffers[i].clear();
-                
-                leftMidBuffers[i].copyFrom(0, 0, source, 0, 0, sourceNumSamples);
-                rightSideBuffers[i].copyFrom(1, 0, source, 1, 0, sourceNumSamples);
-                
-                if ( mode == static_cast<int>(Params::ProcessingMode::Left) )
-                    compressors[i].process(leftMidBuffers[i]);
-                else
-                    compressors[i].process(rightSideBuffers[i]);
-                
-                break;
-            }
-            case static_cast<int>(Params::ProcessingMode::Mid):
-            case static_cast<int>(Params::ProcessingMode::Side):
-            {
-                const auto* L = source.getReadPointer(0);
-                const auto* R = source.getReadPointer(1);
-                auto* M = leftMidBuffers[i].getWritePointer(0);
-                auto* S = rightSideBuffers[i].getWritePointer(1);
-                
-                for ( auto sampleIdx = 0; sampleIdx < sourceNumSamples; ++sampleIdx )
-                {
-                    M[sampleIdx] = juce::jlimit(-1.f, 1.f, (L[sampleIdx] + R[sampleIdx]) * minusThreeDb);
-                    S[sampleIdx] = juce::jlimit(-1.f, 1.f, (L[sampleIdx] - R[sampleIdx]) * minusThreeDb);
-                }
-                
-                if ( mode == static_cast<int>(Params::ProcessingMode::Mid) )
-                    compressors[i].process(leftMidBuffers[i]);
-                else
-                    compressors[i].process(rightSideBuffers[i]);
-                
-                break;
-            }
-            default:
-                break;
+            meterSnapshot.bands[i] = compressors[i].getLevels();
         }
+        
+        meterHistory.push(meterSnapshot);
     }
-    
+
+#if USE_TEST_OSC
     buffer.clear();
+#endif
+
+#if TEST_FILTER_NETWORK
+    if ( apvts.getParameter(Params::getBypassParamName(0))->getValue() > 0.5f )
+    {
+        invertedNetwork.invert();
+        addBand(buffer, invertedNetwork.getProcessedBuffer());
+    }
+#endif
+}
+
+void PFMProject12AudioProcessor::processBands(juce::dsp::AudioBlock<float>& block)
+{
+    activeFilterSequence->process(block);
     
+#if TEST_FILTER_NETWORK
+    invertedNetwork.process(block);
+#endif
+    
+    auto globalMode = static_cast<Params::ProcessingMode>(processingMode->getIndex());
     const auto& afsBufferCount = activeFilterSequence->getBufferCount();
-    const auto& bufferNumSamples = buffer.getNumSamples();
+    
+    // encode in place, then compress only the channels the mode asks for
+    for ( auto i = 0; i < afsBufferCount; ++i )
+    {
+        const auto& routing = BandRouting::get(compressors[i].getProcessingMode(globalMode));
+        bandRoutings[i] = &routing;
+        
+        auto& bandBlock = activeFilterSequence->getFilteredBlock(i);
+        routing.encodeInPlace(bandBlock);
+        
+        auto processedChannels = routing.getProcessedChannels(bandBlock);
+        compressors[i].setStereoLinked(routing.stereoLinked);
+        compressors[i].process(processedChannels);
+    }
+    
+    block.clear();
+    
     bool bandsAreSoloed = false;
     for ( auto i = 0; i < afsBufferCount; ++i )
     {
@@ -466,58 +549,45 @@ void PFMProject12AudioProcessor::processBlock (juce::AudioBuffer<float>& buffer,
         }
     }
     
-    if ( bandsAreSoloed )
-    {
-        for ( auto i = 0; i < afsBufferCount; ++i )
-        {
-            if ( compressors[i].solo->get() )
-            {
-                handleProcessingMode(mode, buffer, bufferNumSamples, i);
-            }
-        }
-    }
-    else
+    // each band is decoded in place (which is what its band output carries) and added to the output sum in the same pass
+    for ( auto i = 0; i < afsBufferCount; ++i )
     {
-        for ( auto i = 0; i < afsBufferCount; ++i )
-        {
-            if ( !compressors[i].mute->get() )
-            {
-                handleProcessingMode(mode, buffer, bufferNumSamples, i);
-            }
-        }
+        auto& bandBlock = activeFilterSequence->getFilteredBlock(i);
+        auto audible = bandsAreSoloed ? compressors[i].solo->get() : !compressors[i].mute->get();
+        
+        if ( audible )
+            bandRoutings[i]->decodeInPlaceAndAdd(bandBlock, block);
+        else
+            bandRoutings[i]->decodeInPlace(bandBlock);
     }
     
-    applyGain(buffer, outputGain);
-    
 #if USE_TEST_OSC
-    buffer.clear();
+    // the test tone replaces the band sum, so it still goes through the output gain and meters
+    block.clear();
     
-    auto block = juce::dsp::AudioBlock<float>(buffer);
     auto context = juce::dsp::ProcessContextReplacing<float>(block);
     testOsc.process(context);
     testGain.setGainDecibels(JUCE_LIVE_CONSTANT(0));
     testGain.process(context);
 #endif
+}
+
+void PFMProject12AudioProcessor::routeBandOutputs(const juce::dsp::AudioBlock<float>& hostBlock)
+{
+    auto numBandsToRoute = juce::jmin(activeFilterSequence->getBufferCount(), static_cast<size_t>(getBusCount(false) - 1));
     
-    updateMeterFifos(outMeterValuesFifo, buffer);
-    
-    if (onOffParam->get() && prePostParam->getCurrentChoiceName() == postStr)
-    {
-        leftSCSF.update(buffer);
-        rightSCSF.update(buffer);
-    }
-    
-#if USE_TEST_OSC
-    buffer.clear();
-#endif
-    
-#if TEST_FILTER_NETWORK
-    if ( apvts.getParameter(Params::getBypassParamName(0))->getValue() > 0.5f )
+    for ( size_t band = 0; band < numBandsToRoute; ++band )
     {
-        invertedNetwork.invert();
-        addBand(buffer, invertedNetwork.getProcessedBuffer());
+        auto busIndex = static_cast<int>(band) + 1;
+        auto* bus = getBus(false, busIndex);
+        
+        if ( bus != nullptr && bus->isEnabled() )
+        {
+            auto firstChannel = static_cast<size_t>(getChannelIndexInProcessBlockBuffer(false, busIndex, 0));
+            auto numChannels = static_cast<size_t>(bus->getNumberOfChannels());
+            activeFilterSequence->routeBandTo(band, hostBlock.getSubsetChannelBlock(firstChannel, numChannels));
+        }
     }
-#endif
 }
 
 void PFMProject12AudioProcessor::addBand(juce::AudioBuffer<float>& target, const juce::AudioBuffer<float>& source)
@@ -543,6 +613,15 @@ void PFMProject12AudioProcessor::updateBands()
     auto crossoverFrequencies = getReorderedCrossovers(getCrossoverParams());
     afSequence->updateFilterCutoffs(crossoverFrequencies);
     
+    // the upper edge of each band decides how often its detector needs to run
+    // offline renders always use the exact per-sample detector, the interval can change mid-stream without a click
+    auto useControlRate = controlRateDetection->get() && !isNonRealtime();
+    for ( size_t i = 0; i < compressors.size(); ++i )
+    {
+        auto upperEdgeHz = i < crossoverFrequencies.size() ? crossoverFrequencies[i] : Globals::getMaxFrequency();
+        compressors[i].updateControlRate(useControlRate, upperEdgeHz);
+    }
+    
     inputGain.setGainDecibels(gainIn->get());
     outputGain.setGainDecibels(gainOut->get());
 }
@@ -589,6 +668,12 @@ void PFMProject12AudioProcessor::updateCrossovers(std::vector<float> xovers, con
     }
 }
 
+void PFMProject12AudioProcessor::resetLoudness()
+{
+    inputLoudness.requestReset();
+    outputLoudness.requestReset();
+}
+
 void PFMProject12AudioProcessor::updateNumberOfBands()
 {
     size_t currentSelection = numBands->get();
@@ -712,6 +797,16 @@ juce::AudioProcessorValueTreeState::ParameterLayout PFMProject12AudioProcessor::
     
     //==============================================================================
     
+    layout.add(std::make_unique<juce::AudioParameterBool>(params.at(Params::Names::Control_Rate_Detection),
+                                                          params.at(Params::Names::Control_Rate_Detection),
+                                                          false));
+    
+    layout.add(std::make_unique<juce::AudioParameterBool>(params.at(Params::Names::Input_Loudness),
+                                                          params.at(Params::Names::Input_Loudness),
+                                                          false));
+    
+    //==============================================================================
+    
     AnalyzerProperties::addAnalyzerParams(layout);
     
     return layout;
@@ -723,6 +818,7 @@ void PFMProject12AudioProcessor::addBandControls(juce::AudioProcessorValueTreeSt
     auto releaseRange = juce::NormalisableRange<float>(5.f, 500.f, 1.f, 1.f);
     auto thresholdRange = juce::NormalisableRange<float>(-60.f, 12.f, 1.f, 1.f);
     auto makeupGainRange = juce::NormalisableRange<float>(0.f, 24.f, 1.f, 1.f);
+    auto rmsWindowRange = juce::NormalisableRange<float>(1.f, 300.f, 1.f, 0.5f);
     
     auto ratioChoices = std::vector<double>{ 1.5, 2, 3, 4, 5, 6, 7, 8, 10, 20, 50, 100 };
     juce::StringArray choicesStringArray;
@@ -768,6 +864,57 @@ void PFMProject12AudioProcessor::addBandControls(juce::AudioProcessorValueTreeSt
     layout.add(std::make_unique<juce::AudioParameterBool>(Params::getBandControlParamName(Params::BandControl::Mute, bandNum),
                                                           Params::getBandControlParamName(Params::BandControl::Mute, bandNum),
                                                           false));
+    
+    juce::StringArray detectorChoices;
+    const auto& detectorModes = Params::getDetectorModes();
+    for ( auto mode : detectorModes )
+    {
+        detectorChoices.add(mode.second);
+    }
+    
+    layout.add(std::make_unique<juce::AudioParameterChoice>(Params::getBandControlParamName(Params::BandControl::Detector, bandNum),
+                                                            Params::getBandControlParamName(Params::BandControl::Detector, bandNum),
+                                                            detectorChoices,
+                                                            static_cast<int>(Params::DetectorMode::Peak)));
+    
+    layout.add(std::make_unique<juce::AudioParameterFloat>(Params::getBandControlParamName(Params::BandControl::RMS_Window, bandNum),
+                                                           Params::getBandControlParamName(Params::BandControl::RMS_Window, bandNum),
+                                                           rmsWindowRange,
+                                                           50.f));
+    
+    juce::StringArray bandModeChoices;
+    const auto& bandModes = Params::getBandProcessingModes();
+    for ( auto mode : bandModes )
+    {
+        bandModeChoices.add(mode.second);
+    }
+    
+    layout.add(std::make_unique<juce::AudioParameterChoice>(Params::getBandControlParamName(Params::BandControl::Mode, bandNum),
+                                                            Params::getBandControlParamName(Params::BandControl::Mode, bandNum),
+                                                            bandModeChoices,
+                                                            static_cast<int>(Params::BandProcessingMode::Global)));
+}
+
+juce::AudioProcessor::BusesProperties PFMProject12AudioProcessor::createBusesProperties()
+{
+    auto properties = BusesProperties()
+                     #if ! JucePlugin_IsMidiEffect
+                      #if ! JucePlugin_IsSynth
+                       .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
+                      #endif
+                       .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
+                     #endif
+                       ;
+    
+    // one optional output per band, carrying the band after dynamics for parallel processing in the host
+    for ( auto i = 0; i < Globals::getNumMaxBands(); ++i )
+    {
+        juce::String busName;
+        busName << "Band " << i;
+        properties = properties.withOutput(busName, juce::AudioChannelSet::stereo(), false);
+    }
+    
+    return properties;
 }
 
 std::vector<float> PFMProject12AudioProcessor::getDefaultCenterFrequencies(size_t numBands)
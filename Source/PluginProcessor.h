@@ -12,7 +12,12 @@
 #include "dsp/Fifo.h"
 #include "dsp/FifoBackgroundUpdater.h"
 #include "dsp/Decibel.h"
-#include "dsp/SingleChannelSampleFifo.h"
+#include "dsp/AnalysisRing.h"
+#include "dsp/BandCompressor.h"
+#include "dsp/BandRouting.h"
+#include "dsp/ProcessingStages.h"
+#include "dsp/MeterSnapshot.h"
+#include "dsp/SeqLockRing.h"
 #include "Params.h"
 #include "Globals.h"
 #include "Channel.h"
@@ -105,7 +110,7 @@ struct InvertedNetwork
     void resize(size_t numBands);
     void updateCutoffs(std::vector<float> xoverFreqs);
     const juce::AudioBuffer<float>& getProcessedBuffer();
-    void process(const juce::AudioBuffer<float>& inputBuffer);
+    void process(const juce::dsp::AudioBlock<float>& input);
     void invert();
     void prepare(const juce::dsp::ProcessSpec& spec);
 private:
@@ -137,6 +142,15 @@ struct FilterSequence : juce::ReferenceCountedObject
         numChannels = spec.numChannels;
         numSamples = spec.maximumBlockSize;
         
+        {
+            const juce::ScopedLock scopedBufferLock(bufferCS);
+            
+            for ( auto& filterBuffer : filterBuffers )
+            {
+                filterBuffer.setSize(numChannels, numSamples, false, true, true);
+            }
+        }
+        
         for ( auto& band : mbFilters )
         {
             for ( auto& filter : band )
@@ -200,22 +214,46 @@ struct FilterSequence : juce::ReferenceCountedObject
 #endif
     }
     
-    void process(const Buffer& input)
+    /*
+    Bands normally end up in the sequence's own buffers. A band routed to a target, e.g. the channels of an aux output bus,
+    is filtered straight into the target instead. Targets only apply to the next call to process().
+    */
+    void routeBandTo(size_t bandNum, const juce::dsp::AudioBlock<float>& target)
+    {
+        jassert( bandNum < getBufferCount() );
+        jassert( static_cast<int>(target.getNumChannels()) == numChannels );
+        bandTargets[bandNum] = target;
+    }
+    
+    void process(const juce::dsp::AudioBlock<float>& input)
     {
         jassert( prepared );
         const juce::ScopedLock scopedBufferLock(bufferCS);
         
-        for ( auto& filterBuffer : filterBuffers )
+        const auto inputNumSamples = input.getNumSamples();
+        jassert( inputNumSamples <= static_cast<size_t>(numSamples) );
+        
+        for ( size_t i = 0; i < filterBuffers.size(); ++i )
+        {
+            if ( bandTargets[i].getNumChannels() > 0 )
+                bandBlocks[i] = bandTargets[i].getSubBlock(0, inputNumSamples);
+            else
+                bandBlocks[i] = juce::dsp::AudioBlock<float>(filterBuffers[i]).getSubBlock(0, inputNumSamples);
+            
+            bandTargets[i] = {};
+        }
+        
+        // every band after the second starts out as a copy of the previous band's high pass, so only two need the input
+        for ( size_t i = 0; i < juce::jmin(size_t(2), bandBlocks.size()); ++i )
         {
-            filterBuffer.clear();
-            filterBuffer = input;
+            bandBlocks[i].copyFrom(input);
         }
         
         const juce::ScopedLock scopedFilterLock(filterCS);
         
-        for ( size_t i = 0; i < filterBuffers.size(); ++i )
+        for ( size_t i = 0; i < bandBlocks.size(); ++i )
         {
-            auto block = juce::dsp::AudioBlock<float>(filterBuffers[i]);
+            auto& block = bandBlocks[i];
             auto context = juce::dsp::ProcessContextReplacing<float>(block);
             
             if ( i == 0 )
@@ -235,7 +273,7 @@ struct FilterSequence : juce::ReferenceCountedObject
                 
                 if ( i != getBufferCount() - 1 )
                 {
-                    filterBuffers[i + 1] = filterBuffers[i];
+                    bandBlocks[i + 1].copyFrom(block);
                     
                     for ( size_t j = 1; j < mbFilters[i].size(); ++j )
                     {
@@ -246,10 +284,11 @@ struct FilterSequence : juce::ReferenceCountedObject
         }
     }
     
-    Buffer& getFilteredBuffer(size_t bandNum)
+    // only valid after process(), and points at the band's target if it was routed to one
+    juce::dsp::AudioBlock<float>& getFilteredBlock(size_t bandNum)
     {
         jassert( bandNum < getBufferCount() );
-        return filterBuffers[bandNum];
+        return bandBlocks[bandNum];
     }
     
     size_t getBufferCount() const
@@ -261,9 +300,12 @@ private:
     void createBuffers(size_t numBands)
     {
         auto buffers = createBuffers(numBands, numChannels, numSamples);
+        std::vector<juce::dsp::AudioBlock<float>> targets(numBands), blocks(numBands);
         const juce::ScopedLock scopedBufferLock(bufferCS);
         
         std::swap(filterBuffers, buffers);
+        std::swap(bandTargets, targets);
+        std::swap(bandBlocks, blocks);
     }
     
     static std::vector<Buffer> createBuffers(size_t numBuffers, int numChannels, int numSamples)
@@ -350,6 +392,7 @@ private:
                                                     
     std::vector<std::vector<Filter>> mbFilters;
     std::vector<Buffer> filterBuffers;
+    std::vector<juce::dsp::AudioBlock<float>> bandTargets, bandBlocks;
     std::vector<float> currentXoverFreqs;
     int numChannels { 2 };
     int numSamples { 512 };
@@ -423,24 +466,14 @@ struct CompressorBand
     void updateCompressor();
     void updateGain();
     void updateBypassState();
-    void process(juce::AudioBuffer<float>& buffer);
+    void updateControlRate(bool controlRateEnabled, float bandUpperEdgeHz);
+    void setStereoLinked(bool shouldBeLinked);
+    void setMeteringEnabled(bool shouldBeEnabled);
+    void process(juce::dsp::AudioBlock<float>& block);
     
-    float getRMSInputLevelDb();
-    float getRMSOutputLevelDb();
+    Params::BandProcessingMode getProcessingMode(Params::ProcessingMode globalMode) const;
     
-    template<typename T>
-    float computeRMSLevel(const T& buffer)
-    {
-        auto numSamples = buffer.getNumSamples();
-        auto numChannels = buffer.getNumChannels();
-        auto sum = 0.f;
-        for ( auto channel = 0; channel < numChannels; ++channel )
-        {
-            sum += buffer.getRMSLevel(channel, 0, numSamples);
-        }
-        
-        return sum / numChannels;
-    }
+    const BandLevel& getLevels() const { return levels; }
     
     juce::AudioParameterFloat*  attack     { nullptr };
     juce::AudioParameterFloat*  release    { nullptr };
@@ -450,15 +483,22 @@ struct CompressorBand
     juce::AudioParameterBool*   bypassed   { nullptr };
     juce::AudioParameterBool*   solo       { nullptr };
     juce::AudioParameterBool*   mute       { nullptr };
+    juce::AudioParameterChoice* detector   { nullptr };
+    juce::AudioParameterFloat*  rmsWindow  { nullptr };
+    juce::AudioParameterChoice* bandMode   { nullptr };
     
 private:
     bool compressorConfigured = false;
     bool gainConfigured = false;
     bool shouldBeBypassed = false;
+    bool meteringEnabled = true;
+    double sampleRate { 44100.0 };
     
-    juce::dsp::Compressor<float> compressor;
+    BandCompressor<float> compressor;
     juce::dsp::Gain<float> gain;
-    std::atomic<float> rmsInputLevelDb, rmsOutputLevelDb;
+    BandLevel levels;
+    
+    void updateLevels();
 };
 
 //==============================================================================
@@ -489,12 +529,6 @@ private:
     juce::Atomic<float> resettableDefaultValue;
 };
 
-//==============================================================================
-struct MeterValues
-{
-    Decibel<float> leftPeakDb, rightPeakDb, leftRmsDb, rightRmsDb;
-};
-
 //==============================================================================
 /**
 */
@@ -538,68 +572,9 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
     
-    template<typename T, typename U>
-    void updateMeterFifos(T& fifo, U& buffer)
-    {
-        const auto& bufferNumSamples = buffer.getNumSamples();
-        
-        MeterValues meterValues;
-        
-        meterValues.leftPeakDb = juce::Decibels::gainToDecibels(buffer.getMagnitude(0, 0, bufferNumSamples));
-        meterValues.rightPeakDb = juce::Decibels::gainToDecibels(buffer.getMagnitude(1, 0, bufferNumSamples));
-        meterValues.leftRmsDb = juce::Decibels::gainToDecibels(buffer.getRMSLevel(0, 0, bufferNumSamples));
-        meterValues.rightRmsDb = juce::Decibels::gainToDecibels(buffer.getRMSLevel(1, 0, bufferNumSamples));
-        
-        fifo.push(meterValues);
-    }
-    
-    template<typename BufferType>
-    void handleProcessingMode(int mode, BufferType& buffer, int numSamples, size_t bandNum)
-    {
-        switch (mode)
-        {
-            case static_cast<int>(Params::ProcessingMode::Stereo):
-            {
-                addBand(buffer, activeFilterSequence->getFilteredBuffer(bandNum));
-                break;
-            }
-            case static_cast<int>(Params::ProcessingMode::Left):
-            case static_cast<int>(Params::ProcessingMode::Right):
-            {
-                addBand(buffer, leftMidBuffers[bandNum]);
-                addBand(buffer, rightSideBuffers[bandNum]);
-                break;
-            }
-            case static_cast<int>(Params::ProcessingMode::Mid):
-            case static_cast<int>(Params::ProcessingMode::Side):
-            {
-                const auto* M = leftMidBuffers[bandNum].getReadPointer(0);
-                const auto* S = rightSideBuffers[bandNum].getReadPointer(1);
-                auto* L = buffer.getWritePointer(0);
-                auto* R = buffer.getWritePointer(1);
-                
-                for ( auto sampleIdx = 0; sampleIdx < buffer.getNumSamples(); ++sampleIdx )
-                {
-                    L[sampleIdx] += juce::jlimit(-1.f, 1.f, (M[sampleIdx] + S[sampleIdx]) * minusThreeDb);
-                    R[sampleIdx] += juce::jlimit(-1.f, 1.f, (M[sampleIdx] - S[sampleIdx]) * minusThreeDb);
-                }
-                
-                break;
-            }
-            default:
-                break;
-        }
-    }
-    
-    template<typename T, typename U>
-    void applyGain(T& buffer, U& gainProcessor)
-    {
-        auto block = juce::dsp::AudioBlock<float>(buffer);
-        auto context = juce::dsp::ProcessContextReplacing<float>(block);
-        gainProcessor.process(context);
-    }
-    
     void addBand(juce::AudioBuffer<float>& target, const juce::AudioBuffer<float>& source);
+    void routeBandOutputs(const juce::dsp::AudioBlock<float>& hostBlock);
+    void processBands(juce::dsp::AudioBlock<float>& block);
     
     void updateBands();
     std::vector<juce::RangedAudioParameter*> getCrossoverParams();
@@ -607,23 +582,28 @@ public:
     void updateCrossovers(std::vector<float> xovers, const std::vector<juce::RangedAudioParameter*>& params);
     
     void updateNumberOfBands();
+    
+    // starts the integrated loudness and loudness range over, on both meters. Safe from any thread.
+    void resetLoudness();
 
     static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
     static void addBandControls(juce::AudioProcessorValueTreeState::ParameterLayout& layout, const int& bandNum);
+    static BusesProperties createBusesProperties();
     
     inline static std::vector<float> getDefaultCenterFrequencies(size_t numBands);
     void updateDefaultCenterFrequencies(size_t numBands);
     
     juce::AudioProcessorValueTreeState apvts { *this, nullptr, "Parameters", createParameterLayout() };
         
-    Fifo<MeterValues, 20> inMeterValuesFifo, outMeterValuesFifo;
+    // one snapshot per processed block, the editor goes through every one it missed since its last frame
+    SeqLockRing<MeterSnapshot, 128> meterHistory;
     
     std::array<CompressorBand, Globals::getNumMaxBands()>& getCompressors() { return compressors; };
     
     std::atomic<size_t> numFilterBands { Globals::getNumMaxBands() };
     
-    SingleChannelSampleFifo<juce::AudioBuffer<float>> leftSCSF { Channel::Left };
-    SingleChannelSampleFifo<juce::AudioBuffer<float>> rightSCSF { Channel::Right };
+    // the last few seconds of left and right, pre or post, for the spectrum analyzer
+    AnalysisRing analysisRing;
 private:
     std::array<CompressorBand, Globals::getNumMaxBands()> compressors;
     
@@ -639,16 +619,46 @@ private:
     juce::AudioParameterFloat* gainIn { nullptr };
     juce::AudioParameterFloat* gainOut { nullptr };
     juce::AudioParameterInt* selectedBand { nullptr };
+    juce::AudioParameterBool* controlRateDetection { nullptr };
+    juce::AudioParameterBool* inputLoudnessEnabled { nullptr };
     
     juce::AudioParameterBool* onOffParam { nullptr };
     juce::AudioParameterChoice* prePostParam { nullptr };
     
-    juce::dsp::Gain<float> inputGain, outputGain;
+    GainStage inputGain, outputGain;
+    MeterSnapshot meterSnapshot;
+    LevelMeterStage<MeterValues> inputMeter { meterSnapshot.in }, outputMeter { meterSnapshot.out };
+    LoudnessStage<MeterValues> inputLoudness { meterSnapshot.in }, outputLoudness { meterSnapshot.out };
     
-    std::array<juce::AudioBuffer<float>, Globals::getNumMaxBands()> leftMidBuffers;
-    std::array<juce::AudioBuffer<float>, Globals::getNumMaxBands()> rightSideBuffers;
+    AnalyzerTapStage preAnalyzerTap { analysisRing }, postAnalyzerTap { analysisRing };
+    
+    // the band split, compressors and band sum, on whatever block the chain hands it
+    struct BandsStage : ProcessingGraph::BlockStage
+    {
+        explicit BandsStage(PFMProject12AudioProcessor& owner) : processor(owner) { }
+        
+        void processBlock(juce::dsp::AudioBlock<float>& block) { processor.processBands(block); }
+    
+    private:
+        PFMProject12AudioProcessor& processor;
+    };
+    
+    BandsStage bands { *this };
+    
+    /*
+    The gain, meter and analyzer stages either side of the band split each run in one fused pass over the buffer,
+    instead of every one of them reading (and the gains writing) the whole buffer again.
+    */
+    ProcessingGraph::Chain<GainStage, AnalyzerTapStage, LevelMeterStage<MeterValues>, LoudnessStage<MeterValues>,
+                           BandsStage,
+                           GainStage, LevelMeterStage<MeterValues>, AnalyzerTapStage, LoudnessStage<MeterValues>> chain
+    {
+        inputGain, preAnalyzerTap, inputMeter, inputLoudness,
+        bands,
+        outputGain, outputMeter, postAnalyzerTap, outputLoudness
+    };
     
-    const float minusThreeDb = juce::Decibels::decibelsToGain(-3.f);
+    std::array<const BandRouting*, Globals::getNumMaxBands()> bandRoutings { };
     
     std::unique_ptr<FifoBackgroundUpdater<int>> defaultCenterFrequenciesUpdater;
     std::unique_ptr<FifoBackgroundUpdater<int>> crossoverFreqOrderingUpdater;
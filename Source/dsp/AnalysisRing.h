@@ -0,0 +1,128 @@
+/*
+  ==============================================================================
+  
+    AnalysisRing.h
+    Created: 18 Oct 2026 11:34:08pm
+    Author:  Matt Aiken
+  
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+The last few seconds of audio, every channel, for the analyzers to read from.
+
+One writer (the audio thread) writes a block into every channel and then publishes it by moving the write position on.
+The write position counts samples since prepare() and never wraps, so a reader can ask for any window ending at or
+before it, read it straight out of the ring, and go back to sleep. Nothing is queued: the writer just overwrites the
+oldest audio, so a reader that's late (or stopped) can't hold up the audio thread or make it drop anything.
+
+A reader that falls a whole ring behind could see audio being overwritten while it copies. The copy is checked against
+the write position afterwards and thrown away if that could have happened, like a seqlock.
+
+prepare() reallocates, so it first stops new reads and waits for any copy that's already under way to finish.
+*/
+struct AnalysisRing
+{
+    // allocates, so not on the audio thread. Only while nothing is writing, but readers can carry on
+    void prepare(int numChannels, double sampleRate, int maximumBlockSize, double secondsToKeep = 4.0)
+    {
+        prepared.store(false);
+        
+        // a read that saw the ring prepared has registered itself before looking, see read()
+        while ( numReaders.load() > 0 )
+            juce::Thread::yield();
+        
+        auto minimumSize = static_cast<int>(std::ceil(sampleRate * secondsToKeep)) + maximumBlockSize;
+        auto size = juce::nextPowerOfTwo(juce::jmax(minimumSize, 1));
+        
+        storage.setSize(numChannels, size);
+        storage.clear();
+        mask = size - 1;
+        maxWriteSize = maximumBlockSize;
+        writePosition.store(0);
+        preparedSampleRate.store(sampleRate);
+        
+        prepared.store(true);
+    }
+    
+    bool isPrepared() const { return prepared.load(); }
+    int getNumChannels() const { return storage.getNumChannels(); }
+    
+    // the rate of the audio being written, as of the last prepare()
+    double getSampleRate() const { return preparedSampleRate.load(); }
+    
+    // the furthest a window can reach back, counting from the write position when it's read
+    int getMaxWindowSize() const { return mask + 1 - maxWriteSize; }
+    
+    // where the next block goes; everything before it is published
+    juce::int64 getWritePosition() const { return writePosition.load(std::memory_order_acquire); }
+    
+    // writes samples 'offset' samples into the block being written, without publishing them
+    void write(int channel, const float* samples, int numSamples, int offset = 0) noexcept
+    {
+        jassert( offset + numSamples <= maxWriteSize );
+        
+        auto start = static_cast<int>((writePosition.load(std::memory_order_relaxed) + offset) & mask);
+        auto firstRun = juce::jmin(numSamples, mask + 1 - start);
+        
+        juce::FloatVectorOperations::copy(storage.getWritePointer(channel, start), samples, firstRun);
+        
+        if ( firstRun < numSamples )
+            juce::FloatVectorOperations::copy(storage.getWritePointer(channel, 0), samples + firstRun, numSamples - firstRun);
+    }
+    
+    // publishes the block written since the last call
+    void advance(int numSamples) noexcept
+    {
+        writePosition.store(writePosition.load(std::memory_order_relaxed) + numSamples, std::memory_order_release);
+    }
+    
+    /*
+    Copies the numSamples ending at endPosition (usually getWritePosition()) from one channel.
+    Anything before the first sample ever written reads as silence.
+    Returns false if the window was, or might have been, overwritten.
+    */
+    bool read(int channel, juce::int64 endPosition, float* destination, int numSamples) const noexcept
+    {
+        numReaders.fetch_add(1);
+        auto result = isPrepared() && readPrepared(channel, endPosition, destination, numSamples);
+        numReaders.fetch_sub(1);
+        
+        return result;
+    }
+
+private:
+    juce::AudioBuffer<float> storage;
+    int mask { 0 }, maxWriteSize { 0 };
+    std::atomic<juce::int64> writePosition { 0 };
+    std::atomic<bool> prepared { false };
+    std::atomic<double> preparedSampleRate { 0.0 };
+    mutable std::atomic<int> numReaders { 0 };
+    
+    bool readPrepared(int channel, juce::int64 endPosition, float* destination, int numSamples) const noexcept
+    {
+        if ( channel >= getNumChannels() || numSamples > getMaxWindowSize() )
+            return false;
+        
+        auto startPosition = endPosition - numSamples;
+        if ( getWritePosition() - startPosition > getMaxWindowSize() )
+            return false;
+        
+        auto start = static_cast<int>(startPosition & mask);
+        auto firstRun = juce::jmin(numSamples, mask + 1 - start);
+        
+        juce::FloatVectorOperations::copy(destination, storage.getReadPointer(channel, start), firstRun);
+        
+        if ( firstRun < numSamples )
+            juce::FloatVectorOperations::copy(destination + firstRun, storage.getReadPointer(channel, 0), numSamples - firstRun);
+        
+        // the writer may have lapped us while we were copying
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return getWritePosition() - startPosition <= getMaxWindowSize();
+    }
+};
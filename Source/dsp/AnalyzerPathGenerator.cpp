@@ -18,57 +18,122 @@ void AnalyzerPathGenerator::generatePath(const std::vector<float>& renderData,
                                          float negativeInfinity,
                                          float maxDb)
 {
-    auto numBins = static_cast<int>(fftSize * 0.5);
+    auto width = static_cast<int>(fftBounds.getWidth());
+    if ( width <= 0 )
+        return;
     
-    const float minFreq = Globals::getMinFrequency();
-    const float maxFreq = Globals::getMaxFrequency();
-    
-    auto fftBoundsBottom = fftBounds.getBottom();
-    auto fftBoundsY = fftBounds.getY();
-    auto fftBoundsWidth = fftBounds.getWidth();
+    if ( fftSize != mappedFFTSize || width != mappedWidth || binWidth != mappedBinWidth || ! mappedFrequencies.empty() )
+    {
+        buildColumnMap(width, fftSize / 2, [binWidth](float frequency) { return frequency / binWidth; });
+        mappedFFTSize = fftSize;
+        mappedBinWidth = binWidth;
+        mappedFrequencies.clear();
+    }
     
-    juce::Path path;
-    path.preallocateSpace(3 * static_cast<int>(fftBoundsWidth));
+    reduceToColumns(renderData);
+    updateColumnPositions(fftBounds, negativeInfinity, maxDb);
+}
 
-    auto yCoord = juce::jmap<float>(renderData[0], negativeInfinity, maxDb, fftBoundsBottom, fftBoundsY);
-    if ( std::isnan(yCoord) || std::isinf(yCoord) )
+void AnalyzerPathGenerator::generatePath(const std::vector<float>& renderData,
+                                         juce::Rectangle<float> fftBounds,
+                                         const std::vector<float>& binFrequencies,
+                                         float negativeInfinity,
+                                         float maxDb)
+{
+    auto width = static_cast<int>(fftBounds.getWidth());
+    if ( width <= 0 || binFrequencies.size() < 2 )
+        return;
+    
+    if ( width != mappedWidth || binFrequencies != mappedFrequencies )
     {
-        yCoord = fftBoundsBottom;
+        auto binPosition = [&binFrequencies](float frequency)
+        {
+            auto upper = std::upper_bound(binFrequencies.begin() + 1, binFrequencies.end() - 1, frequency);
+            auto lowerBin = static_cast<int>(std::distance(binFrequencies.begin(), upper)) - 1;
+            auto lower = binFrequencies[static_cast<size_t>(lowerBin)];
+            return static_cast<float>(lowerBin) + (frequency - lower) / (*upper - lower);
+        };
+        
+        buildColumnMap(width, static_cast<int>(binFrequencies.size()) - 1, binPosition);
+        mappedFFTSize = 0;
+        mappedBinWidth = 0.f;
+        mappedFrequencies = binFrequencies;
     }
     
-    path.startNewSubPath(0, yCoord);
+    reduceToColumns(renderData);
+    updateColumnPositions(fftBounds, negativeInfinity, maxDb);
+}
+
+void AnalyzerPathGenerator::updateColumnPositions(juce::Rectangle<float> fftBounds, float negativeInfinity, float maxDb)
+{
+    auto height = fftBounds.getHeight();
+    
+    auto toY = [=](float db)
+    {
+        auto yCoord = juce::jmap<float>(db, negativeInfinity, maxDb, height, 0.f);
+        return std::isfinite(yCoord) ? yCoord : height;
+    };
+    
+    columnPositions.resize(columnLevels.size());
+    std::transform(columnLevels.begin(), columnLevels.end(), columnPositions.begin(), toY);
+}
+
+template <typename BinPosition>
+void AnalyzerPathGenerator::buildColumnMap(int width, int lastBin, BinPosition binPosition)
+{
+    const auto minFreq = Globals::getMinFrequency();
+    const auto maxFreq = Globals::getMaxFrequency();
     
-    auto lastXCoord = fftBounds.getX();
+    // the frequency at the left edge of a column, or anywhere in between
+    auto frequencyAt = [=](float x) { return juce::mapToLog10(x / static_cast<float>(width), minFreq, maxFreq); };
     
-    const int pathResolution = 2;
+    columnMap.resize(static_cast<size_t>(width));
+    columnLevels.resize(static_cast<size_t>(width));
     
-    for ( auto i = 1; i < numBins + 1; i += pathResolution )
+    for ( auto x = 0; x < width; ++x )
     {
-        yCoord = juce::jmap<float>(renderData[i], negativeInfinity, maxDb, fftBoundsBottom, fftBoundsY);
-
-        if ( !std::isnan(yCoord) && !std::isinf(yCoord) )
+        // bins whose centre frequency falls in [left edge, right edge)
+        auto firstBin = static_cast<int>(std::ceil(binPosition(frequencyAt(static_cast<float>(x)))));
+        auto endBin = static_cast<int>(std::ceil(binPosition(frequencyAt(static_cast<float>(x + 1)))));
+        
+        firstBin = juce::jlimit(0, lastBin, firstBin);
+        endBin = juce::jlimit(firstBin, lastBin + 1, endBin);
+        
+        auto& column = columnMap[static_cast<size_t>(x)];
+        
+        if ( endBin > firstBin )
         {
-            auto binFreq = i * binWidth;
-            auto normalizedX = juce::mapFromLog10(binFreq, minFreq, maxFreq);
-            auto xCoord = std::floor(normalizedX * fftBoundsWidth);
-
-            if ( xCoord - lastXCoord >= pathResolution && xCoord <= fftBoundsWidth )
-            {
-                path.lineTo(xCoord, yCoord);
-                lastXCoord = xCoord;
-            }
+            column = { firstBin, endBin, 0.f };
+        }
+        else
+        {
+            auto position = juce::jlimit(0.f, static_cast<float>(lastBin), binPosition(frequencyAt(x + 0.5f)));
+            auto lowerBin = juce::jmin(static_cast<int>(position), lastBin - 1);
+            column = { lowerBin, lowerBin, position - static_cast<float>(lowerBin) };
         }
     }
     
-    pathFifo.push(path);
+    mappedWidth = width;
 }
 
-int AnalyzerPathGenerator::getNumPathsAvailable() const
+void AnalyzerPathGenerator::reduceToColumns(const std::vector<float>& renderData)
 {
-    return pathFifo.getNumAvailableForReading();
+    // the columns cover the bins in order, so between them this reads each bin once
+    for ( size_t x = 0; x < columnMap.size(); ++x )
+    {
+        const auto& column = columnMap[x];
+        auto& level = columnLevels[x];
+        
+        if ( column.endBin == column.firstBin )
+        {
+            auto lower = renderData[static_cast<size_t>(column.firstBin)];
+            auto upper = renderData[static_cast<size_t>(column.firstBin + 1)];
+            level = lower + column.fraction * (upper - lower);
+        }
+        else
+        {
+            level = *std::max_element(renderData.begin() + column.firstBin, renderData.begin() + column.endBin);
+        }
+    }
 }
 
-bool AnalyzerPathGenerator::getPath(juce::Path& path)
-{
-    return pathFifo.pull(path);
-}
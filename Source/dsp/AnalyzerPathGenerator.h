@@ -12,9 +12,21 @@
 
 #include <JuceHeader.h>
 #include "../Globals.h"
-#include "Fifo.h"
 
 //==============================================================================
+/*
+Turns a spectrum into a path with one point per pixel column, log spaced from Globals::getMinFrequency() to
+getMaxFrequency(). The path is kept as each column's y, measured down from the top of fftBounds, which is what
+SpectrumRasterizer draws from.
+
+Which bins land in which column is worked out once per FFT size, width and bin width and kept until one of them changes.
+Each frame is then one pass over the bins: a column that covers several bins shows their max, so a narrow peak
+at the top end can't fall between points, and a column narrower than a bin (the low end, at small FFT sizes)
+interpolates between the two bins either side of it. Building the path is then O(width) whatever the FFT size.
+
+The bins don't have to be evenly spaced: the second generatePath() takes the centre frequency of every bin instead,
+for spectra stitched together from several resolutions.
+*/
 struct AnalyzerPathGenerator
 {
     void generatePath(const std::vector<float>& renderData,
@@ -24,8 +36,30 @@ struct AnalyzerPathGenerator
                       float negativeInfinity = Globals::getNegativeInf(),
                       float maxDb = Globals::getMaxDecibels());
     
-    int getNumPathsAvailable() const;
-    bool getPath(juce::Path& path);
+    void generatePath(const std::vector<float>& renderData,
+                      juce::Rectangle<float> fftBounds,
+                      const std::vector<float>& binFrequencies,
+                      float negativeInfinity = Globals::getNegativeInf(),
+                      float maxDb = Globals::getMaxDecibels());
+    
+    // one per pixel column of the last generatePath()'s fftBounds
+    const std::vector<float>& getColumnPositions() const { return columnPositions; }
 private:
-    Fifo<juce::Path, 20> pathFifo;
+    struct Column
+    {
+        int firstBin, endBin; // the bins inside the column, or if there are none, the bin below it and...
+        float fraction;       // ...how far the column's centre is from that bin to the next one
+    };
+    
+    std::vector<Column> columnMap;
+    std::vector<float> columnLevels, columnPositions;
+    int mappedFFTSize { 0 }, mappedWidth { 0 };
+    float mappedBinWidth { 0.f };
+    std::vector<float> mappedFrequencies; // empty while the map is for evenly spaced bins
+    
+    // binPosition maps a frequency to a fractional bin index, and must be increasing
+    template <typename BinPosition>
+    void buildColumnMap(int width, int lastBin, BinPosition binPosition);
+    void reduceToColumns(const std::vector<float>& renderData);
+    void updateColumnPositions(juce::Rectangle<float> fftBounds, float negativeInfinity, float maxDb);
 };
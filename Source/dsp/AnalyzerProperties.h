@@ -22,7 +22,13 @@ enum ParamNames
     Enable_Analyzer,
     Analyzer_Decay_Rate,
     Analyzer_Points,
-    Analyzer_Processing_Mode
+    Analyzer_Processing_Mode,
+    Analyzer_Overlap,
+    Analyzer_Multi_Resolution,
+    Analyzer_Averaging,
+    Analyzer_Averaging_Time,
+    Analyzer_Smoothing,
+    Analyzer_Fill
 };
 
 enum ProcessingModes
@@ -31,6 +37,42 @@ enum ProcessingModes
     Post
 };
 
+// how far apart consecutive FFT frames start. every mode is capped to the display rate
+enum OverlapModes
+{
+    Overlap50,
+    Overlap75,
+    DisplayRate // one frame per displayed frame, whatever the FFT size
+};
+
+// what the analyzer does with each new frame, see SpectrumAverager
+enum AveragingModes
+{
+    MaxEnvelope,
+    MinEnvelope,
+    Average,
+    PeakHold,
+    TimedHold
+};
+
+// fractional-octave smoothing, see SpectrumSmoother
+enum SmoothingModes
+{
+    SmoothingOff,
+    OneOctave,
+    ThirdOctave,
+    SixthOctave,
+    TwelfthOctave,
+    TwentyFourthOctave
+};
+
+// the N in 1/N octave, 0 for none
+inline int getOctaveFraction(SmoothingModes mode)
+{
+    static constexpr std::array<int, 6> fractions { 0, 1, 3, 6, 12, 24 };
+    return fractions[static_cast<size_t>(mode)];
+}
+
 inline const std::map<ParamNames, juce::String>& getAnalyzerParams()
 {
     static std::map<ParamNames, juce::String> paramNamesMap =
@@ -38,7 +80,13 @@ inline const std::map<ParamNames, juce::String>& getAnalyzerParams()
         { Enable_Analyzer,          "Enable Analyzer" },
         { Analyzer_Decay_Rate,      "Analyzer Decay Rate" },
         { Analyzer_Points,          "Analyzer Points" },
-        { Analyzer_Processing_Mode, "Analyzer Processing Mode" }
+        { Analyzer_Processing_Mode, "Analyzer Processing Mode" },
+        { Analyzer_Overlap,         "Analyzer Overlap" },
+        { Analyzer_Multi_Resolution, "Analyzer Multi-Resolution" },
+        { Analyzer_Averaging,       "Analyzer Averaging" },
+        { Analyzer_Averaging_Time,  "Analyzer Averaging Time" },
+        { Analyzer_Smoothing,       "Analyzer Smoothing" },
+        { Analyzer_Fill,            "Analyzer Fill" }
     };
     
     return paramNamesMap;
@@ -67,11 +115,55 @@ inline const std::map<ProcessingModes, juce::String>& getProcessingModes()
     return processingModesMap;
 }
 
+inline const std::map<OverlapModes, juce::String>& getOverlapModes()
+{
+    static std::map<OverlapModes, juce::String> overlapModesMap =
+    {
+        { Overlap50,   "50%" },
+        { Overlap75,   "75%" },
+        { DisplayRate, "Display Rate" }
+    };
+    
+    return overlapModesMap;
+}
+
+inline const std::map<AveragingModes, juce::String>& getAveragingModes()
+{
+    static std::map<AveragingModes, juce::String> averagingModesMap =
+    {
+        { MaxEnvelope, "Max Envelope" },
+        { MinEnvelope, "Min Envelope" },
+        { Average,     "Average" },
+        { PeakHold,    "Peak Hold" },
+        { TimedHold,   "Timed Hold" }
+    };
+    
+    return averagingModesMap;
+}
+
+inline const std::map<SmoothingModes, juce::String>& getSmoothingModes()
+{
+    static std::map<SmoothingModes, juce::String> smoothingModesMap =
+    {
+        { SmoothingOff,       "Off" },
+        { OneOctave,          "1/1 Octave" },
+        { ThirdOctave,        "1/3 Octave" },
+        { SixthOctave,        "1/6 Octave" },
+        { TwelfthOctave,      "1/12 Octave" },
+        { TwentyFourthOctave, "1/24 Octave" }
+    };
+    
+    return smoothingModesMap;
+}
+
 inline void addAnalyzerParams(juce::AudioProcessorValueTreeState::ParameterLayout& layout)
 {
     const auto& params = getAnalyzerParams();
     const auto& fftOrders = getAnalyzerPoints();
     const auto& processingModes = getProcessingModes();
+    const auto& overlapModes = getOverlapModes();
+    const auto& averagingModes = getAveragingModes();
+    const auto& smoothingModes = getSmoothingModes();
     
     layout.add(std::make_unique<juce::AudioParameterChoice>(params.at(Analyzer_Points),
                                                             params.at(Analyzer_Points),
@@ -82,15 +174,48 @@ inline void addAnalyzerParams(juce::AudioProcessorValueTreeState::ParameterLayou
                                                             params.at(Analyzer_Processing_Mode),
                                                             juce::StringArray { processingModes.at(Pre), processingModes.at(Post) },
                                                             1));
+    
+    layout.add(std::make_unique<juce::AudioParameterChoice>(params.at(Analyzer_Overlap),
+                                                            params.at(Analyzer_Overlap),
+                                                            juce::StringArray { overlapModes.at(Overlap50), overlapModes.at(Overlap75), overlapModes.at(DisplayRate) },
+                                                            1));
 
     layout.add(std::make_unique<juce::AudioParameterBool>(params.at(Enable_Analyzer),
                                                           params.at(Enable_Analyzer),
                                                           true));
     
+    // decimated FFTs instead of one. Analyzer_Points only applies without it
+    layout.add(std::make_unique<juce::AudioParameterBool>(params.at(Analyzer_Multi_Resolution),
+                                                          params.at(Analyzer_Multi_Resolution),
+                                                          false));
+    
+    // shades the area under each trace
+    layout.add(std::make_unique<juce::AudioParameterBool>(params.at(Analyzer_Fill),
+                                                          params.at(Analyzer_Fill),
+                                                          false));
+    
     layout.add(std::make_unique<juce::AudioParameterFloat>(params.at(Analyzer_Decay_Rate),
                                                            params.at(Analyzer_Decay_Rate),
                                                            juce::NormalisableRange<float>(0.f, 30.f, 0.1f, 1.f),
                                                            30.f));
+    
+    layout.add(std::make_unique<juce::AudioParameterChoice>(params.at(Analyzer_Averaging),
+                                                            params.at(Analyzer_Averaging),
+                                                            juce::StringArray { averagingModes.at(MaxEnvelope), averagingModes.at(MinEnvelope), averagingModes.at(Average),
+                                                                                averagingModes.at(PeakHold), averagingModes.at(TimedHold) },
+                                                            0));
+    
+    // the time constant for Average, the hold time for Timed Hold
+    layout.add(std::make_unique<juce::AudioParameterFloat>(params.at(Analyzer_Averaging_Time),
+                                                           params.at(Analyzer_Averaging_Time),
+                                                           juce::NormalisableRange<float>(10.f, 10000.f, 1.f, 0.3f),
+                                                           500.f));
+    
+    layout.add(std::make_unique<juce::AudioParameterChoice>(params.at(Analyzer_Smoothing),
+                                                            params.at(Analyzer_Smoothing),
+                                                            juce::StringArray { smoothingModes.at(SmoothingOff), smoothingModes.at(OneOctave), smoothingModes.at(ThirdOctave),
+                                                                                smoothingModes.at(SixthOctave), smoothingModes.at(TwelfthOctave), smoothingModes.at(TwentyFourthOctave) },
+                                                            0));
 }
 
 }
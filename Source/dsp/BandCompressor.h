@@ -0,0 +1,685 @@
+/*
+  ==============================================================================
+  
+    BandCompressor.h
+    Created: 18 Oct 2026 10:14:52am
+    Author:  Matt Aiken
+  
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "RunningMeanSquare.h"
+#include "FastMath.h"
+
+//==============================================================================
+/*
+Drop-in replacement for juce::dsp::Compressor (same peak ballistics and gain curve).
+
+With a control rate interval of 1 every sample runs through the detector and gain computer, like the JUCE compressor.
+The gain curve isn't bit exact though: for float it goes through FastMath's High accuracy log2/exp2 instead of std::pow,
+which keeps the gain within about 0.00003 dB of the exact curve (see the error table in FastMath.h).
+With an interval of N the detector only sees the peak of every N samples (using ballistics coefficients scaled for the decimated rate),
+the gain computer runs once per N samples and the gain applied on the audio path is linearly interpolated towards the new target.
+
+Channels whose envelope has settled well below the threshold skip the detector and gain computer altogether
+until the signal gets close to the threshold again.
+
+The RMS detector feeds the ballistics with the RMS level of a sliding window (see RunningMeanSquare) instead of the
+rectified signal.
+
+When stereo linked, all channels share one detector fed with the loudest channel (peak) or the mean power (RMS),
+and the same gain is applied to every channel so the stereo image doesn't shift.
+
+The input and output levels and the deepest gain reduction of every block are gathered by the same loops that do the
+processing (see getStatistics()), so metering a band doesn't cost any passes over the audio of its own.
+*/
+template<typename SampleType>
+struct BandCompressor
+{
+    enum class Detector
+    {
+        Peak,
+        RMS
+    };
+    
+    // peak and sum of squares of a run of samples
+    struct Level
+    {
+        SampleType peak { 0 }, sumOfSquares { 0 };
+        
+        void add(SampleType sample) noexcept
+        {
+            peak = juce::jmax(peak, std::abs(sample));
+            sumOfSquares += sample * sample;
+        }
+        
+        void add(const Level& other) noexcept
+        {
+            peak = juce::jmax(peak, other.peak);
+            sumOfSquares += other.sumOfSquares;
+        }
+    };
+    
+    /*
+    Covers every channel of the last processed block. The gains are the ones the gain computer produced
+    (one detector's worth when linked), so they're the real gain reduction, with no makeup gain mixed in.
+    */
+    struct Statistics
+    {
+        Level input, output;
+        SampleType minGain { 1 }, gainSum { 0 };
+        size_t numValues { 0 }, numGains { 0 };
+        
+        SampleType getInputRMS() const noexcept { return getRMS(input); }
+        SampleType getOutputRMS() const noexcept { return getRMS(output); }
+        
+        SampleType getMeanGain() const noexcept
+        {
+            return numGains > 0 ? gainSum / static_cast<SampleType>(numGains) : static_cast<SampleType>(1);
+        }
+        
+        void addUnityGains(size_t numSamples) noexcept
+        {
+            gainSum += static_cast<SampleType>(numSamples);
+            numGains += numSamples;
+        }
+    
+    private:
+        SampleType getRMS(const Level& level) const noexcept
+        {
+            return numValues > 0 ? std::sqrt(level.sumOfSquares / static_cast<SampleType>(numValues)) : static_cast<SampleType>(0);
+        }
+    };
+    
+    void prepare(const juce::dsp::ProcessSpec& spec)
+    {
+        jassert( spec.sampleRate > 0 );
+        jassert( spec.numChannels > 0 );
+        
+        sampleRate = spec.sampleRate;
+        
+        envelopes.assign(spec.numChannels, static_cast<SampleType>(0));
+        pendingPeaks.assign(spec.numChannels, static_cast<SampleType>(0));
+        gains.assign(spec.numChannels, static_cast<SampleType>(1));
+        gainSteps.assign(spec.numChannels, static_cast<SampleType>(0));
+        samplesUntilUpdate.assign(spec.numChannels, controlRateInterval);
+        handoverOffsets.assign(spec.numChannels, static_cast<SampleType>(0));
+        handoverSamples.assign(spec.numChannels, 0);
+        
+        linkedLevels.assign(spec.maximumBlockSize, static_cast<SampleType>(0));
+        linkedGains.assign(spec.maximumBlockSize, static_cast<SampleType>(1));
+        
+        rmsWindows.resize(spec.numChannels);
+        auto maxWindowLength = static_cast<int>(std::ceil(sampleRate * 0.001 * getMaxRMSWindowMs()));
+        for ( auto& window : rmsWindows )
+        {
+            window.prepare(maxWindowLength);
+        }
+        
+        update();
+        reset();
+    }
+    
+    void reset()
+    {
+        std::fill(envelopes.begin(), envelopes.end(), static_cast<SampleType>(0));
+        std::fill(pendingPeaks.begin(), pendingPeaks.end(), static_cast<SampleType>(0));
+        std::fill(gains.begin(), gains.end(), static_cast<SampleType>(1));
+        std::fill(gainSteps.begin(), gainSteps.end(), static_cast<SampleType>(0));
+        std::fill(samplesUntilUpdate.begin(), samplesUntilUpdate.end(), controlRateInterval);
+        std::fill(handoverOffsets.begin(), handoverOffsets.end(), static_cast<SampleType>(0));
+        std::fill(handoverSamples.begin(), handoverSamples.end(), 0);
+        
+        for ( auto& window : rmsWindows )
+        {
+            window.reset();
+        }
+    }
+    
+    void setThreshold(SampleType newThresholdDb)
+    {
+        thresholdDb = newThresholdDb;
+        update();
+    }
+    
+    void setRatio(SampleType newRatio)
+    {
+        jassert( newRatio >= static_cast<SampleType>(1) );
+        ratio = newRatio;
+        update();
+    }
+    
+    void setAttack(SampleType newAttackMs)
+    {
+        attackMs = newAttackMs;
+        update();
+    }
+    
+    void setRelease(SampleType newReleaseMs)
+    {
+        releaseMs = newReleaseMs;
+        update();
+    }
+    
+    // the shared detector runs on channel 0's state, so linking and unlinking carries on from where it was
+    void setStereoLinked(bool shouldBeLinked)
+    {
+        stereoLinked = shouldBeLinked;
+    }
+    
+    void setDetector(Detector newDetector)
+    {
+        detector = newDetector;
+    }
+    
+    void setRMSWindow(SampleType newWindowMs)
+    {
+        jassert( newWindowMs >= getMinRMSWindowMs() && newWindowMs <= getMaxRMSWindowMs() );
+        rmsWindowMs = juce::jlimit(getMinRMSWindowMs(), getMaxRMSWindowMs(), newWindowMs);
+        update();
+    }
+    
+    const Statistics& getStatistics() const noexcept { return statistics; }
+    
+    static constexpr SampleType getMinRMSWindowMs() { return static_cast<SampleType>(1); }
+    static constexpr SampleType getMaxRMSWindowMs() { return static_cast<SampleType>(300); }
+    
+    /*
+    Changing the interval doesn't reset anything: the pending peak is carried over and the gain keeps ramping
+    from wherever it currently is, so the detector can be switched between per-sample and control rate at any time.
+    
+    Going per-sample in the middle of a ramp, the difference between where the ramp is and what the gain computer
+    now asks for fades out over what was left of the ramp, instead of the gain stepping straight to it.
+    */
+    void setControlRateInterval(int numSamples)
+    {
+        jassert( numSamples >= 1 && numSamples <= getMaxControlRateInterval() );
+        numSamples = juce::jlimit(1, getMaxControlRateInterval(), numSamples);
+        
+        if ( numSamples == controlRateInterval )
+            return;
+        
+        controlRateInterval = numSamples;
+        
+        for ( size_t channel = 0; channel < samplesUntilUpdate.size(); ++channel )
+        {
+            auto rampInFlight = controlRateInterval == 1 && gainSteps[channel] != static_cast<SampleType>(0);
+            handoverOffsets[channel] = rampInFlight ? gains[channel] - computeGain(envelopes[channel]) : static_cast<SampleType>(0);
+            handoverSamples[channel] = rampInFlight ? samplesUntilUpdate[channel] : 0;
+            
+            samplesUntilUpdate[channel] = juce::jmin(samplesUntilUpdate[channel], controlRateInterval);
+        }
+        
+        update();
+    }
+    
+    int getControlRateInterval() const { return controlRateInterval; }
+    
+    static constexpr int getMaxControlRateInterval() { return 64; }
+    
+    // hard knee, so this is only the headroom below threshold where the band stops being considered settled
+    static constexpr SampleType getSettledMarginDb() { return static_cast<SampleType>(1); }
+    
+    /*
+    A band can't produce anything above its upper crossover, so its rectified envelope is band limited too.
+    One detector update per period of the upper edge is plenty, and the interval is kept well inside the attack time
+    so the attack ramp is still resolved by the interpolation.
+    */
+    static int getControlRateIntervalFor(double sampleRate, float bandUpperEdgeHz, float attackTimeMs)
+    {
+        jassert( sampleRate > 0 );
+        
+        if ( bandUpperEdgeHz <= 0.f )
+            return 1;
+        
+        auto samplesPerPeriod = sampleRate / static_cast<double>(bandUpperEdgeHz);
+        auto samplesPerQuarterAttack = sampleRate * 0.001 * static_cast<double>(attackTimeMs) * 0.25;
+        auto maxInterval = juce::jlimit(1, getMaxControlRateInterval(), static_cast<int>(juce::jmin(samplesPerPeriod, samplesPerQuarterAttack)));
+        
+        // round down to a power of 2 so the ticks line up between bands
+        auto interval = 1;
+        while ( interval * 2 <= maxInterval )
+            interval *= 2;
+        
+        return interval;
+    }
+    
+    template<typename ProcessContext>
+    void process(const ProcessContext& context) noexcept
+    {
+        const auto& inputBlock = context.getInputBlock();
+        auto& outputBlock      = context.getOutputBlock();
+        const auto numChannels = outputBlock.getNumChannels();
+        const auto numSamples  = outputBlock.getNumSamples();
+        
+        jassert( inputBlock.getNumChannels() == numChannels );
+        jassert( inputBlock.getNumSamples() == numSamples );
+        jassert( numChannels <= envelopes.size() );
+        
+        statistics = Statistics();
+        statistics.numValues = numChannels * numSamples;
+        
+        if ( context.isBypassed )
+        {
+            for ( size_t channel = 0; channel < numChannels; ++channel )
+            {
+                statistics.input.add(measure(inputBlock.getChannelPointer(channel), numSamples));
+            }
+            
+            statistics.output = statistics.input;
+            statistics.addUnityGains(numSamples);
+            outputBlock.copyFrom(inputBlock);
+            return;
+        }
+        
+        if ( stereoLinked && numChannels > 1 )
+        {
+            processLinked(inputBlock, outputBlock);
+            return;
+        }
+        
+        for ( size_t channel = 0; channel < numChannels; ++channel )
+        {
+            const auto* input = inputBlock.getChannelPointer(channel);
+            auto* output = outputBlock.getChannelPointer(channel);
+            
+            auto inputLevel = measure(input, numSamples);
+            statistics.input.add(inputLevel);
+            
+            if ( processChannel(channel, input, output, numSamples, inputLevel.peak) )
+            {
+                // the gain is exactly unity
+                statistics.output.add(inputLevel);
+                
+                if ( input != output )
+                    juce::FloatVectorOperations::copy(output, input, static_cast<int>(numSamples));
+            }
+        }
+    }
+
+private:
+    template<typename InputBlock, typename OutputBlock>
+    void processLinked(const InputBlock& inputBlock, OutputBlock& outputBlock) noexcept
+    {
+        const auto numChannels = outputBlock.getNumChannels();
+        const auto numSamples  = outputBlock.getNumSamples();
+        
+        jassert( numSamples <= linkedLevels.size() );
+        
+        auto* levels = linkedLevels.data();
+        
+        // the input is measured while the detector levels are built
+        if ( detector == Detector::RMS )
+        {
+            // the window squares its input, so feeding it the root of the mean power averages the channels' power
+            for ( size_t channel = 0; channel < numChannels; ++channel )
+            {
+                const auto* input = inputBlock.getChannelPointer(channel);
+                for ( size_t i = 0; i < numSamples; ++i )
+                {
+                    auto square = input[i] * input[i];
+                    levels[i] = channel == 0 ? square : levels[i] + square;
+                    statistics.input.add(input[i]);
+                }
+            }
+            
+            auto channelScale = static_cast<SampleType>(1) / static_cast<SampleType>(numChannels);
+            for ( size_t i = 0; i < numSamples; ++i )
+            {
+                levels[i] = std::sqrt(levels[i] * channelScale);
+            }
+        }
+        else
+        {
+            for ( size_t channel = 0; channel < numChannels; ++channel )
+            {
+                const auto* input = inputBlock.getChannelPointer(channel);
+                for ( size_t i = 0; i < numSamples; ++i )
+                {
+                    auto level = std::abs(input[i]);
+                    levels[i] = channel == 0 ? level : juce::jmax(levels[i], level);
+                    statistics.input.add(input[i]);
+                }
+            }
+        }
+        
+        // neither the loudest channel nor the root of the mean power can be above the loudest sample of any channel
+        auto unity = processChannel<true>(0, levels, linkedGains.data(), numSamples, statistics.input.peak);
+        
+        if ( unity )
+        {
+            statistics.output = statistics.input;
+            
+            for ( size_t channel = 0; channel < numChannels; ++channel )
+            {
+                const auto* input = inputBlock.getChannelPointer(channel);
+                auto* output = outputBlock.getChannelPointer(channel);
+                
+                if ( input != output )
+                    juce::FloatVectorOperations::copy(output, input, static_cast<int>(numSamples));
+            }
+            
+            return;
+        }
+        
+        const auto* gainsToApply = linkedGains.data();
+        for ( size_t channel = 0; channel < numChannels; ++channel )
+        {
+            const auto* input = inputBlock.getChannelPointer(channel);
+            auto* output = outputBlock.getChannelPointer(channel);
+            
+            for ( size_t i = 0; i < numSamples; ++i )
+            {
+                output[i] = input[i] * gainsToApply[i];
+                statistics.output.add(output[i]);
+            }
+        }
+    }
+    
+    static Level measure(const SampleType* data, size_t numSamples) noexcept
+    {
+        Level level;
+        for ( size_t i = 0; i < numSamples; ++i )
+        {
+            level.add(data[i]);
+        }
+        
+        return level;
+    }
+    
+    /*
+    Runs one detector over the input. With writeGainOnly the gain is written to the output instead of being applied,
+    which is how the linked detector drives several channels.
+    Returns true when the channel was settled and the gain is exactly unity, in which case the output is left untouched.
+    blockPeak has to be at least the largest level the input holds, the caller has already measured it.
+    */
+    template<bool writeGainOnly = false>
+    bool processChannel(size_t channel, const SampleType* input, SampleType* output, size_t numSamples, SampleType blockPeak) noexcept
+    {
+        auto levelBound = getDetectorLevelBound(channel, blockPeak, numSamples);
+        
+        if ( isSettled(channel, levelBound) )
+        {
+            // all that's left is keeping track of the envelope
+            advanceSettledChannel(channel, input, levelBound, numSamples);
+            statistics.addUnityGains(numSamples);
+            return true;
+        }
+        
+        if ( controlRateInterval == 1 )
+            processChannelPerSample<writeGainOnly>(channel, input, output, numSamples);
+        else
+            processChannelAtControlRate<writeGainOnly>(channel, input, output, numSamples);
+        
+        return false;
+    }
+    
+    void update()
+    {
+        threshold = juce::Decibels::decibelsToGain(thresholdDb, static_cast<SampleType>(-200));
+        settledThreshold = juce::Decibels::decibelsToGain(thresholdDb - getSettledMarginDb(), static_cast<SampleType>(-200));
+        thresholdInverse = static_cast<SampleType>(1) / threshold;
+        ratioInverse = static_cast<SampleType>(1) / ratio;
+        
+        cteAttack = calculateLimitedCte(attackMs, 1);
+        cteRelease = calculateLimitedCte(releaseMs, 1);
+        cteAttackDecimated = calculateLimitedCte(attackMs, controlRateInterval);
+        cteReleaseDecimated = calculateLimitedCte(releaseMs, controlRateInterval);
+        
+        auto rmsWindowLength = static_cast<int>(std::round(sampleRate * 0.001 * static_cast<double>(rmsWindowMs)));
+        for ( auto& window : rmsWindows )
+        {
+            window.setWindowLength(rmsWindowLength);
+        }
+    }
+    
+    // same as juce::dsp::BallisticsFilter, but for a detector that only runs every 'interval' samples
+    SampleType calculateLimitedCte(SampleType timeMs, int interval) const
+    {
+        if ( timeMs < static_cast<SampleType>(1.0e-3) )
+            return static_cast<SampleType>(0);
+        
+        auto expFactor = -2.0 * juce::MathConstants<double>::pi * 1000.0 * static_cast<double>(interval) / sampleRate;
+        return static_cast<SampleType>(std::exp(expFactor / static_cast<double>(timeMs)));
+    }
+    
+    SampleType computeGain(SampleType env) const noexcept
+    {
+        if ( env < threshold )
+            return static_cast<SampleType>(1);
+        
+        // (env / threshold)^(1/ratio - 1), without going through libm for every sample
+        if constexpr ( std::is_same_v<SampleType, float> )
+        {
+            auto overshoot = FastMath::log2<FastMath::Accuracy::High>(env * thresholdInverse);
+            return FastMath::exp2<FastMath::Accuracy::High>(overshoot * (ratioInverse - 1.f));
+        }
+        else
+        {
+            return std::pow(env * thresholdInverse, ratioInverse - static_cast<SampleType>(1));
+        }
+    }
+    
+    SampleType runDetector(SampleType peak, SampleType previous, SampleType cteAT, SampleType cteRL) const noexcept
+    {
+        auto cte = ( peak > previous ) ? cteAT : cteRL;
+        return peak + cte * (previous - peak);
+    }
+    
+    /*
+    The highest level the detector can be fed during the next block. For the peak detector that's simply the block peak.
+    The RMS window can't hold more energy than it does now plus every incoming sample at the block peak.
+    */
+    SampleType getDetectorLevelBound(size_t channel, SampleType blockPeak, size_t numSamples) const noexcept
+    {
+        if ( detector == Detector::Peak )
+            return blockPeak;
+        
+        const auto& window = rmsWindows[channel];
+        auto incoming = static_cast<SampleType>(numSamples) / static_cast<SampleType>(window.getWindowLength());
+        return std::sqrt(window.getMeanSquare() + incoming * blockPeak * blockPeak);
+    }
+    
+    /*
+    A channel is settled when its gain has come to rest at unity and neither the envelope nor anything the detector
+    can see in this block gets within the settling margin of the threshold. The margin gives the exact path a head start
+    before the signal actually reaches the threshold.
+    */
+    bool isSettled(size_t channel, SampleType levelBound) const noexcept
+    {
+        if ( levelBound >= settledThreshold || envelopes[channel] >= settledThreshold )
+            return false;
+        
+        // a control rate ramp back to unity can finish a hair off due to rounding
+        return std::abs(gains[channel] - static_cast<SampleType>(1)) <= static_cast<SampleType>(1.0e-5);
+    }
+    
+    /*
+    Whatever the ballistics do inside the block, they can't end up above where they'd be if every sample sat at the
+    level bound: an envelope above it releases towards it, one below it attacks towards it. That's below the settling
+    margin, which is all the gain computer needs to know, and it hands the exact path a sensible starting point.
+    */
+    void advanceSettledChannel(size_t channel, const SampleType* input, SampleType levelBound, size_t numSamples) noexcept
+    {
+        if ( detector == Detector::RMS )
+        {
+            auto& window = rmsWindows[channel];
+            for ( size_t i = 0; i < numSamples; ++i )
+            {
+                window.push(input[i]);
+            }
+        }
+        
+        auto& env = envelopes[channel];
+        auto cte = ( env < levelBound ) ? cteAttack : cteRelease;
+        env = levelBound + std::pow(cte, static_cast<SampleType>(numSamples)) * (env - levelBound);
+        
+        gains[channel] = static_cast<SampleType>(1);
+        gainSteps[channel] = static_cast<SampleType>(0);
+        pendingPeaks[channel] = static_cast<SampleType>(0);
+        handoverSamples[channel] = 0;
+    }
+    
+    template<bool writeGainOnly>
+    void processChannelPerSample(size_t channel, const SampleType* input, SampleType* output, size_t numSamples) noexcept
+    {
+        auto env = envelopes[channel];
+        auto gain = gains[channel];
+        auto& window = rmsWindows[channel];
+        auto minGain = statistics.minGain;
+        auto gainSum = static_cast<SampleType>(0);
+        Level outputLevel;
+        
+        // what's left of the handover from a control rate ramp, see setControlRateInterval()
+        auto offset = handoverOffsets[channel];
+        auto handover = static_cast<size_t>(handoverSamples[channel]);
+        auto offsetStep = handover > 0 ? -offset / static_cast<SampleType>(handover) : static_cast<SampleType>(0);
+        auto handoverLength = juce::jmin(handover, numSamples);
+        
+        for ( size_t i = 0; i < numSamples; ++i )
+        {
+            SampleType level;
+            if ( detector == Detector::RMS )
+            {
+                window.push(input[i]);
+                level = window.getRMS();
+            }
+            else
+            {
+                level = std::abs(input[i]);
+            }
+            
+            env = runDetector(level, env, cteAttack, cteRelease);
+            gain = computeGain(env);
+            
+            if ( i < handoverLength )
+            {
+                offset += offsetStep;
+                gain += offset;
+            }
+            
+            output[i] = applyGain<writeGainOnly>(input[i], gain);
+            minGain = juce::jmin(minGain, gain);
+            gainSum += gain;
+            
+            if constexpr ( !writeGainOnly )
+                outputLevel.add(output[i]);
+        }
+        
+        statistics.minGain = minGain;
+        statistics.gainSum += gainSum;
+        statistics.numGains += numSamples;
+        statistics.output.add(outputLevel);
+        
+        envelopes[channel] = env;
+        gains[channel] = gain;
+        gainSteps[channel] = static_cast<SampleType>(0);
+        pendingPeaks[channel] = static_cast<SampleType>(0);
+        samplesUntilUpdate[channel] = controlRateInterval;
+        handoverOffsets[channel] = offset;
+        handoverSamples[channel] = static_cast<int>(handover - handoverLength);
+    }
+    
+    template<bool writeGainOnly>
+    void processChannelAtControlRate(size_t channel, const SampleType* input, SampleType* output, size_t numSamples) noexcept
+    {
+        auto env = envelopes[channel];
+        auto gain = gains[channel];
+        auto step = gainSteps[channel];
+        auto peak = pendingPeaks[channel];
+        auto remaining = samplesUntilUpdate[channel];
+        auto& window = rmsWindows[channel];
+        
+        // the gain moves in straight lines, so its lowest point is always at the end of a run
+        auto minGain = juce::jmin(statistics.minGain, gain);
+        auto gainSum = static_cast<SampleType>(0);
+        Level outputLevel;
+        
+        size_t i = 0;
+        while ( i < numSamples )
+        {
+            auto runLength = juce::jmin(static_cast<size_t>(remaining), numSamples - i);
+            
+            if ( detector == Detector::RMS )
+            {
+                // the window does the averaging, the detector just samples it at each tick
+                for ( size_t j = 0; j < runLength; ++j )
+                {
+                    window.push(input[i + j]);
+                    output[i + j] = applyGain<writeGainOnly>(input[i + j], gain + step * static_cast<SampleType>(j));
+                    
+                    if constexpr ( !writeGainOnly )
+                        outputLevel.add(output[i + j]);
+                }
+                
+                peak = window.getRMS();
+            }
+            else
+            {
+                for ( size_t j = 0; j < runLength; ++j )
+                {
+                    peak = juce::jmax(peak, std::abs(input[i + j]));
+                    output[i + j] = applyGain<writeGainOnly>(input[i + j], gain + step * static_cast<SampleType>(j));
+                    
+                    if constexpr ( !writeGainOnly )
+                        outputLevel.add(output[i + j]);
+                }
+            }
+            
+            // the sum over the ramp, gain + step * j for j in [0, runLength)
+            auto run = static_cast<SampleType>(runLength);
+            gainSum += run * gain + step * run * (run - static_cast<SampleType>(1)) * static_cast<SampleType>(0.5);
+            
+            gain += step * run;
+            minGain = juce::jmin(minGain, gain);
+            i += runLength;
+            remaining -= static_cast<int>(runLength);
+            
+            if ( remaining == 0 )
+            {
+                env = runDetector(peak, env, cteAttackDecimated, cteReleaseDecimated);
+                step = (computeGain(env) - gain) / static_cast<SampleType>(controlRateInterval);
+                peak = static_cast<SampleType>(0);
+                remaining = controlRateInterval;
+            }
+        }
+        
+        statistics.minGain = minGain;
+        statistics.gainSum += gainSum;
+        statistics.numGains += numSamples;
+        statistics.output.add(outputLevel);
+        
+        envelopes[channel] = env;
+        gains[channel] = gain;
+        gainSteps[channel] = step;
+        pendingPeaks[channel] = peak;
+        samplesUntilUpdate[channel] = remaining;
+    }
+    
+    template<bool writeGainOnly>
+    static SampleType applyGain(SampleType input, SampleType gain) noexcept
+    {
+        return writeGainOnly ? gain : gain * input;
+    }
+    
+    std::vector<SampleType> envelopes, pendingPeaks, gains, gainSteps;
+    std::vector<SampleType> linkedLevels, linkedGains;
+    std::vector<int> samplesUntilUpdate;
+    std::vector<SampleType> handoverOffsets; // per-sample gain minus the gain computer's, fading out after a ramp
+    std::vector<int> handoverSamples;
+    std::vector<RunningMeanSquare<SampleType>> rmsWindows;
+    Statistics statistics;
+    
+    Detector detector { Detector::Peak };
+    bool stereoLinked { false };
+    
+    double sampleRate { 44100.0 };
+    int controlRateInterval { 1 };
+    
+    SampleType thresholdDb { 0 }, ratio { 1 }, attackMs { 1 }, releaseMs { 100 }, rmsWindowMs { 50 };
+    SampleType threshold { 1 }, settledThreshold { 1 }, thresholdInverse { 1 }, ratioInverse { 1 };
+    SampleType cteAttack { 0 }, cteRelease { 0 }, cteAttackDecimated { 0 }, cteReleaseDecimated { 0 };
+};
@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+  
+    BandRouting.h
+    Created: 18 Oct 2026 5:06:33pm
+    Author:  Matt Aiken
+  
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../Params.h"
+
+//==============================================================================
+/*
+How a band gets from L/R to the channels its compressor sees, and back again.
+
+Every mode is an encode matrix, the range of encoded channels the compressor runs on, and a decode matrix.
+The table is built once, so per band the audio thread just encodes the filtered band in place,
+compresses a channel subset of that same block and decodes it in place while adding it to the output sum.
+Nothing gets copied into side buffers, and mixing modes across bands costs nothing extra.
+
+Stereo compresses L and R with their own detectors, Linked drives both from one. Mid/side is -3 dB on both sides and,
+like the matrixing always has, clips what it encodes and decodes to +/-1.
+*/
+struct BandRouting
+{
+    using Matrix = std::array<float, 4>; // { LL, LR, RL, RR }, out[0] = m[0] * in[0] + m[1] * in[1]
+    
+    Matrix encode, decode;
+    bool needsMatrix;
+    size_t firstProcessedChannel, numProcessedChannels;
+    bool stereoLinked;
+    
+    static const BandRouting& get(Params::BandProcessingMode mode)
+    {
+        jassert( mode != Params::BandProcessingMode::Global );
+        
+        static const auto routings = makeRoutings();
+        auto index = juce::jlimit(0, static_cast<int>(routings.size()) - 1, static_cast<int>(mode) - 1);
+        return routings[static_cast<size_t>(index)];
+    }
+    
+    void encodeInPlace(juce::dsp::AudioBlock<float>& block) const noexcept
+    {
+        if ( needsMatrix && block.getNumChannels() > 1 )
+            applyMatrix(encode, block);
+    }
+    
+    juce::dsp::AudioBlock<float> getProcessedChannels(juce::dsp::AudioBlock<float>& block) const noexcept
+    {
+        // a mono bus has nothing to route, the one channel is always processed
+        if ( block.getNumChannels() < 2 )
+            return block;
+        
+        return block.getSubsetChannelBlock(firstProcessedChannel, numProcessedChannels);
+    }
+    
+    void decodeInPlace(juce::dsp::AudioBlock<float>& band) const noexcept
+    {
+        if ( needsMatrix && band.getNumChannels() > 1 )
+            applyMatrix(decode, band);
+    }
+    
+    // the band is left decoded, so whatever else reads it (e.g. a band output bus) sees L/R again
+    void decodeInPlaceAndAdd(juce::dsp::AudioBlock<float>& band, juce::dsp::AudioBlock<float>& output) const noexcept
+    {
+        jassert( band.getNumChannels() == output.getNumChannels() );
+        jassert( band.getNumSamples() == output.getNumSamples() );
+        
+        if ( !needsMatrix || band.getNumChannels() < 2 )
+        {
+            output.add(band);
+            return;
+        }
+        
+        auto* first = band.getChannelPointer(0);
+        auto* second = band.getChannelPointer(1);
+        auto* left = output.getChannelPointer(0);
+        auto* right = output.getChannelPointer(1);
+        
+        for ( size_t i = 0; i < band.getNumSamples(); ++i )
+        {
+            auto l = decode[0] * first[i] + decode[1] * second[i];
+            auto r = decode[2] * first[i] + decode[3] * second[i];
+            l = juce::jlimit(-1.f, 1.f, l);
+            r = juce::jlimit(-1.f, 1.f, r);
+            first[i] = l;
+            second[i] = r;
+            left[i] += l;
+            right[i] += r;
+        }
+    }
+
+private:
+    static void applyMatrix(const Matrix& matrix, juce::dsp::AudioBlock<float>& block) noexcept
+    {
+        auto* first = block.getChannelPointer(0);
+        auto* second = block.getChannelPointer(1);
+        
+        for ( size_t i = 0; i < block.getNumSamples(); ++i )
+        {
+            auto a = first[i];
+            auto b = second[i];
+            first[i]  = juce::jlimit(-1.f, 1.f, matrix[0] * a + matrix[1] * b);
+            second[i] = juce::jlimit(-1.f, 1.f, matrix[2] * a + matrix[3] * b);
+        }
+    }
+    
+    static std::array<BandRouting, 6> makeRoutings()
+    {
+        const Matrix identity { 1.f, 0.f, 0.f, 1.f };
+        
+        const auto k = juce::Decibels::decibelsToGain(-3.f);
+        const Matrix midSide { k, k, k, -k };
+        
+        // in the same order as Params::BandProcessingMode, without Global
+        return
+        {{
+            { identity, identity, false, 0, 2, false }, // Stereo
+            { identity, identity, false, 0, 1, false }, // Left
+            { identity, identity, false, 1, 1, false }, // Right
+            { midSide,  midSide,  true,  0, 1, false }, // Mid
+            { midSide,  midSide,  true,  1, 1, false }, // Side
+            { identity, identity, false, 0, 2, true }   // Linked
+        }};
+    }
+};
@@ -11,18 +11,16 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "FastMath.h"
 
 //==============================================================================
 template<typename FloatType>
 struct Decibel
 {
-    Decibel() { }
+    Decibel() = default;
     Decibel(const FloatType& val) : floatVal(val) { }
     
-    // rule of 3: copy constructor, assignment copy operator, destructor
-    Decibel(const Decibel& other) : floatVal(other.floatVal) { }
-    Decibel& operator=(const Decibel& other) { floatVal = other.floatVal; return *this; }
-    ~Decibel() { }
+    // the implicit copy operations keep this trivially copyable, so it can go through lock-free handoffs bytewise
     
     Decibel& operator+=(const Decibel& other) { floatVal += other.floatVal; return *this; }
     Decibel& operator-=(const Decibel& other) { floatVal -= other.floatVal; return *this; }
@@ -56,8 +54,39 @@ struct Decibel
     FloatType getGain() const { return juce::Decibels::decibelsToGain(floatVal); }
     FloatType getDb()   const { return floatVal; }
     
-    void setGain(FloatType g) const { floatVal = juce::Decibels::gainToDecibels(g); }
-    void setDb(FloatType db)  const { floatVal = db; }
+    void setGain(FloatType g) { floatVal = juce::Decibels::gainToDecibels(g); }
+    void setDb(FloatType db)  { floatVal = db; }
+    
+    // whole array conversions, gains and decibels can be the same array. See FastMath.h for what each accuracy costs.
+    template<FastMath::Accuracy accuracy = FastMath::Accuracy::Medium>
+    static void gainsToDecibels(const FloatType* gains, FloatType* decibels, int numValues,
+                                FloatType minusInfinityDb = static_cast<FloatType>(-100))
+    {
+        if constexpr ( std::is_same_v<FloatType, float> )
+        {
+            FastMath::gainsToDecibels<accuracy>(gains, decibels, numValues, minusInfinityDb);
+        }
+        else
+        {
+            for ( auto i = 0; i < numValues; ++i )
+                decibels[i] = juce::Decibels::gainToDecibels(gains[i], minusInfinityDb);
+        }
+    }
+    
+    template<FastMath::Accuracy accuracy = FastMath::Accuracy::Medium>
+    static void decibelsToGains(const FloatType* decibels, FloatType* gains, int numValues,
+                                FloatType minusInfinityDb = static_cast<FloatType>(-100))
+    {
+        if constexpr ( std::is_same_v<FloatType, float> )
+        {
+            FastMath::decibelsToGains<accuracy>(decibels, gains, numValues, minusInfinityDb);
+        }
+        else
+        {
+            for ( auto i = 0; i < numValues; ++i )
+                gains[i] = juce::Decibels::decibelsToGain(decibels[i], minusInfinityDb);
+        }
+    }
 private:
-    FloatType floatVal;
+    FloatType floatVal { 0 };
 };
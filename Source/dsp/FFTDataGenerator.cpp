@@ -9,30 +9,70 @@
 */
 
 #include "FFTDataGenerator.h"
+#include <numeric>
+#include "FastMath.h"
 #include "../Globals.h"
 
 //==============================================================================
-void FFTDataGenerator::produceFFTDataForRendering(const juce::AudioBuffer<float>& audioData)
+void FFTDataGenerator::produceStereoFFTDataForRendering(const juce::AudioBuffer<float>& audioData)
 {
-    const auto fftSize = getFFTSize();
+    const auto numValues = (getNumBins() + 1) * 2;
+    
+    // every frame is still waiting to be read, so this one would only be dropped
+    auto index = framePool.acquire();
+    if ( index < 0 )
+        return;
+    
+    auto& frame = framePool.get(index);
+    frame.resize(static_cast<size_t>(numValues));
+    transformStereo(audioData.getReadPointer(0),
+                    audioData.getReadPointer(audioData.getNumChannels() > 1 ? 1 : 0),
+                    frame.data());
+    
+    publish(index);
+}
 
-    std::fill(fftData.begin(), fftData.end(), 0.f);
+void FFTDataGenerator::transformStereo(const float* left, const float* right, float* destination)
+{
+    const auto fftSize = getFFTSize();
+    const auto numBins = getNumBins();
+    
+    // one windowing pass for both channels: left goes in the real part, right in the imaginary part
+    for ( auto i = 0; i < fftSize; ++i )
+    {
+        timeData[i] = { left[i] * windowTable[i], right[i] * windowTable[i] };
+    }
     
-    auto* bufferReadIdx = audioData.getReadPointer(0);
-    std::copy(bufferReadIdx, bufferReadIdx + fftSize, fftData.begin());
+    forwardFFT->perform(timeData.data(), frequencyData.data(), false);
     
-    window->multiplyWithWindowingTable(fftData.data(), static_cast<size_t>(fftSize));
-    forwardFFT->performFrequencyOnlyForwardTransform(fftData.data(), true);
+    /*
+    The spectrum of a real signal is conjugate symmetric, so with Z = L + jR the two spectra come back apart as
+        L[k] = (Z[k] + conj(Z[N - k])) / 2
+        R[k] = (Z[k] - conj(Z[N - k])) / 2j
+    Only the powers are kept here (the 1/j doesn't change them, and no square roots are needed):
+    the halves go into the scale along with everything else, and the decibel pass takes 10 log10.
+    */
+    auto* rightBins = destination + numBins + 1;
     
-    auto numBins = static_cast<int>(fftSize * 0.5);
-    juce::FloatVectorOperations::multiply(fftData.data(), 1.f / static_cast<float>(numBins), numBins+1);
-        
-    for ( auto i = 0; i < numBins + 1; ++i )
+    for ( auto k = 0; k <= numBins; ++k )
     {
-        fftData[i] = juce::Decibels::gainToDecibels(fftData[i], Globals::getNegativeInf());
+        auto z = frequencyData[k];
+        auto mirrored = std::conj(frequencyData[(fftSize - k) & (fftSize - 1)]);
+        
+        destination[k] = std::norm(z + mirrored);
+        rightBins[k] = std::norm(z - mirrored);
     }
     
-    fftDataFifo.push(fftData);
+    auto powerScale = 0.5f * magnitudeScale;
+    powerScale *= powerScale;
+    FastMath::scaledPowersToDecibels<FastMath::Accuracy::Low>(destination, destination, (numBins + 1) * 2, powerScale, Globals::getNegativeInf());
+}
+
+void FFTDataGenerator::publish(int index)
+{
+    // if the queue is full this frame is dropped and goes straight back to the pool
+    if ( !frameQueue.push(index) )
+        framePool.release(index);
 }
 
 void FFTDataGenerator::changeOrder(FFTOrder newOrder)
@@ -41,10 +81,24 @@ void FFTDataGenerator::changeOrder(FFTOrder newOrder)
     forwardFFT = std::make_unique<juce::dsp::FFT>(order);
     
     auto fftSize = getFFTSize();
-    window = std::make_unique<juce::dsp::WindowingFunction<float>>(fftSize, juce::dsp::WindowingFunction<float>::blackmanHarris);
     
-    fftData.clear();
-    fftData.resize(static_cast<size_t>(fftSize * 2), 0.f);
+    // left unnormalised, its gain is taken out with the rest of the scaling
+    windowTable.resize(static_cast<size_t>(fftSize));
+    juce::dsp::WindowingFunction<float>::fillWindowingTables(windowTable.data(), static_cast<size_t>(fftSize),
+                                                            juce::dsp::WindowingFunction<float>::blackmanHarris, false);
+    
+    auto coherentGain = std::accumulate(windowTable.begin(), windowTable.end(), 0.0) / fftSize;
+    magnitudeScale = static_cast<float>(1.0 / (getNumBins() * coherentGain));
     
-    fftDataFifo.prepare(fftData.size());
+    timeData.resize(static_cast<size_t>(fftSize));
+    frequencyData.resize(static_cast<size_t>(fftSize));
+    
+    // every frame has room for both channels, so filling one never allocates
+    auto maxFrameSize = static_cast<size_t>((getNumBins() + 1) * 2);
+    frameQueue.clear(framePool);
+    framePool.prepare([maxFrameSize](auto& frame)
+    {
+        frame.clear();
+        frame.reserve(maxFrameSize);
+    });
 }
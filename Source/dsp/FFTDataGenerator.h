@@ -10,22 +10,43 @@
 
 #pragma once
 
-#include "Fifo.h"
+#include "FramePool.h"
 #include "FFTOrder.h"
 
 //==============================================================================
 struct FFTDataGenerator
 {
-    void produceFFTDataForRendering(const juce::AudioBuffer<float>& audioData);
+    // both channels from one complex FFT. the right channel's bins follow the left's, from getNumBins() + 1 on
+    void produceStereoFFTDataForRendering(const juce::AudioBuffer<float>& audioData);
+    
+    // the stereo transform on its own, for callers that keep the results themselves: (getNumBins() + 1) * 2 values
+    void transformStereo(const float* left, const float* right, float* destination);
+    
+    // every frame is getNumBins() + 1 decibel values per channel, nothing more
+    
     void changeOrder(FFTOrder newOrder);
     int getFFTSize() const { return 1 << order; }
-    int getNumAvailableFFTDataBlocks() const { return fftDataFifo.getNumAvailableForReading(); }
-    bool getFFTData(std::vector<float>& data) { return fftDataFifo.pull(data); }
+    int getNumBins() const { return getFFTSize() / 2; }
+    int getNumAvailableFFTDataBlocks() const { return frameQueue.getNumAvailableForReading(); }
+    
+    // the oldest frame waiting, or -1. it's read in place with getFFTFrame() and handed back with releaseFFTFrame()
+    int pullFFTFrame() { return frameQueue.pull(); }
+    const std::vector<float>& getFFTFrame(int index) const { return framePool.get(index); }
+    void releaseFFTFrame(int index) { framePool.release(index); }
 private:
     FFTOrder order;
-    std::vector<float> fftData;
     std::unique_ptr<juce::dsp::FFT> forwardFFT;
-    std::unique_ptr<juce::dsp::WindowingFunction<float>> window;
     
-    Fifo<std::vector<float>, 20> fftDataFifo;
+    // 1 / numBins and the window's coherent gain, applied in the same pass as the conversion to decibels
+    float magnitudeScale { 1.f };
+    
+    // frames are transformed straight into a free one from the pool and passed on by index
+    FramePool<std::vector<float>, 8> framePool;
+    FrameQueue<8> frameQueue;
+    
+    void publish(int index);
+    
+    // the stereo transform windows both channels as it packs them
+    std::vector<float> windowTable;
+    std::vector<juce::dsp::Complex<float>> timeData, frequencyData;
 };
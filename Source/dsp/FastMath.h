@@ -0,0 +1,387 @@
+/*
+  ==============================================================================
+  
+    FastMath.h
+    Created: 18 Oct 2026 3:52:14pm
+    Author:  Matt Aiken
+  
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <cstring>
+
+#if JUCE_USE_SIMD && JUCE_INTEL
+ #include <emmintrin.h>
+ #define FAST_MATH_USE_SSE 1
+#elif JUCE_USE_SIMD && JUCE_ARM && (defined (__ARM_NEON__) || defined (__ARM_NEON))
+ #include <arm_neon.h>
+ #define FAST_MATH_USE_NEON 1
+#endif
+
+//==============================================================================
+/*
+Polynomial log2 / exp2 approximations for converting between gain and decibels in bulk.
+
+Both split the float into exponent and mantissa, so the polynomial only ever has to cover one octave.
+The polynomials are pinned so log2(1) and exp2(0) are exact, which keeps unity gain at exactly 0 dB.
+
+Worst case errors, measured against double precision libm. log2 over the whole normal float range,
+exp2 over [-126, 127], gain -> dB over [-100 dB, +24 dB] and dB -> gain over [-99 dB, +40 dB]:
+
+    Accuracy    log2 (abs)    gain -> dB     exp2 (rel)    dB -> gain
+    Low         7.8e-4        0.0047 dB      8.6e-5        0.00075 dB
+    Medium      1.9e-5        0.0001 dB      3.0e-6        0.00003 dB
+    High        4.3e-6        0.000012 dB    9.4e-8        0.0000066 dB
+
+At High the error mostly comes from rounding the result to a float rather than from the polynomial.
+Low is plenty for anything that only ends up on screen.
+
+log2 expects positive, normal input. exp2 clamps its input to the normal float range.
+The batch functions run four values at a time on SSE2 / NEON and accept the same array as source and destination.
+*/
+namespace FastMath
+{
+
+enum class Accuracy
+{
+    Low,
+    Medium,
+    High
+};
+
+namespace detail
+{
+
+// log2(1 + t) = t * (c0 + c1 t + c2 t^2 ...) for t in [0, 1)
+template<Accuracy accuracy> struct Log2Coefficients;
+
+template<> struct Log2Coefficients<Accuracy::Low>
+{
+    static constexpr std::array<float, 3> values { 1.424598603e+00f, -5.892271224e-01f, 1.654020164e-01f };
+};
+
+template<> struct Log2Coefficients<Accuracy::Medium>
+{
+    static constexpr std::array<float, 5> values { 1.441965706e+00f, -7.096639679e-01f, 4.176000382e-01f,
+                                                   -1.962756121e-01f, 4.638817588e-02f };
+};
+
+template<> struct Log2Coefficients<Accuracy::High>
+{
+    static constexpr std::array<float, 7> values { 1.442667830e+00f, -7.205854951e-01f, 4.735536421e-01f,
+                                                   -3.259028318e-01f, 1.942958590e-01f, -7.955904302e-02f,
+                                                   1.553034598e-02f };
+};
+
+// 2^f = 1 + f * (c0 + c1 f + c2 f^2 ...) for f in [0, 1)
+template<Accuracy accuracy> struct Exp2Coefficients;
+
+template<> struct Exp2Coefficients<Accuracy::Low>
+{
+    static constexpr std::array<float, 3> values { 6.951159161e-01f, 2.276488847e-01f, 7.706347532e-02f };
+};
+
+template<> struct Exp2Coefficients<Accuracy::Medium>
+{
+    static constexpr std::array<float, 4> values { 6.930448633e-01f, 2.412800566e-01f, 5.224279284e-02f,
+                                                   1.342648580e-02f };
+};
+
+template<> struct Exp2Coefficients<Accuracy::High>
+{
+    static constexpr std::array<float, 6> values { 6.931470445e-01f, 2.402293054e-01f, 5.548528153e-02f,
+                                                   9.675449390e-03f, 1.246786934e-03f, 2.161282717e-04f };
+};
+
+//==============================================================================
+// The kernels below are written once against these, one lane for the scalar ops and four for the SIMD ones.
+struct ScalarOps
+{
+    using Float = float;
+    using Int = juce::int32;
+    
+    static constexpr int width = 1;
+    
+    static Float load(const float* src) noexcept { return *src; }
+    static void store(float* dest, Float x) noexcept { *dest = x; }
+    static Float set(float value) noexcept { return value; }
+    static Int setInt(Int value) noexcept { return value; }
+    
+    static Float add(Float a, Float b) noexcept { return a + b; }
+    static Float sub(Float a, Float b) noexcept { return a - b; }
+    static Float mul(Float a, Float b) noexcept { return a * b; }
+    static Float mulAdd(Float a, Float b, Float c) noexcept { return a * b + c; }
+    static Float min(Float a, Float b) noexcept { return b < a ? b : a; }
+    static Float max(Float a, Float b) noexcept { return a < b ? b : a; }
+    static Float abs(Float x) noexcept { return std::abs(x); }
+    static Float zeroUnlessGreater(Float x, Float value, Float threshold) noexcept { return value > threshold ? x : 0.f; }
+    static Float pickIfGreater(Float value, Float threshold, Float x, Float otherwise) noexcept { return value > threshold ? x : otherwise; }
+    
+    static Int truncate(Float x) noexcept { return static_cast<Int>(x); }
+    static Float toFloat(Int i) noexcept { return static_cast<Float>(i); }
+    static Int asInt(Float x) noexcept { Int i; std::memcpy(&i, &x, sizeof(i)); return i; }
+    static Float asFloat(Int i) noexcept { Float x; std::memcpy(&x, &i, sizeof(x)); return x; }
+    static Int andInt(Int a, Int b) noexcept { return a & b; }
+    static Int orInt(Int a, Int b) noexcept { return a | b; }
+    static Int subInt(Int a, Int b) noexcept { return a - b; }
+    static Int exponentBits(Int i) noexcept { return static_cast<Int>(static_cast<juce::uint32>(i) >> 23); }
+    static Int toExponent(Int i) noexcept { return static_cast<Int>(static_cast<juce::uint32>(i) << 23); }
+};
+
+#if FAST_MATH_USE_SSE
+struct SIMDOps
+{
+    using Float = __m128;
+    using Int = __m128i;
+    
+    static constexpr int width = 4;
+    
+    static Float load(const float* src) noexcept { return _mm_loadu_ps(src); }
+    static void store(float* dest, Float x) noexcept { _mm_storeu_ps(dest, x); }
+    static Float set(float value) noexcept { return _mm_set1_ps(value); }
+    static Int setInt(juce::int32 value) noexcept { return _mm_set1_epi32(value); }
+    
+    static Float add(Float a, Float b) noexcept { return _mm_add_ps(a, b); }
+    static Float sub(Float a, Float b) noexcept { return _mm_sub_ps(a, b); }
+    static Float mul(Float a, Float b) noexcept { return _mm_mul_ps(a, b); }
+    static Float mulAdd(Float a, Float b, Float c) noexcept { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+    static Float min(Float a, Float b) noexcept { return _mm_min_ps(a, b); }
+    static Float max(Float a, Float b) noexcept { return _mm_max_ps(a, b); }
+    static Float abs(Float x) noexcept { return _mm_andnot_ps(_mm_set1_ps(-0.f), x); }
+    static Float zeroUnlessGreater(Float x, Float value, Float threshold) noexcept { return _mm_and_ps(x, _mm_cmpgt_ps(value, threshold)); }
+    static Float pickIfGreater(Float value, Float threshold, Float x, Float otherwise) noexcept
+    {
+        auto mask = _mm_cmpgt_ps(value, threshold);
+        return _mm_or_ps(_mm_and_ps(mask, x), _mm_andnot_ps(mask, otherwise));
+    }
+    
+    static Int truncate(Float x) noexcept { return _mm_cvttps_epi32(x); }
+    static Float toFloat(Int i) noexcept { return _mm_cvtepi32_ps(i); }
+    static Int asInt(Float x) noexcept { return _mm_castps_si128(x); }
+    static Float asFloat(Int i) noexcept { return _mm_castsi128_ps(i); }
+    static Int andInt(Int a, Int b) noexcept { return _mm_and_si128(a, b); }
+    static Int orInt(Int a, Int b) noexcept { return _mm_or_si128(a, b); }
+    static Int subInt(Int a, Int b) noexcept { return _mm_sub_epi32(a, b); }
+    static Int exponentBits(Int i) noexcept { return _mm_srli_epi32(i, 23); }
+    static Int toExponent(Int i) noexcept { return _mm_slli_epi32(i, 23); }
+};
+#elif FAST_MATH_USE_NEON
+struct SIMDOps
+{
+    using Float = float32x4_t;
+    using Int = int32x4_t;
+    
+    static constexpr int width = 4;
+    
+    static Float load(const float* src) noexcept { return vld1q_f32(src); }
+    static void store(float* dest, Float x) noexcept { vst1q_f32(dest, x); }
+    static Float set(float value) noexcept { return vdupq_n_f32(value); }
+    static Int setInt(juce::int32 value) noexcept { return vdupq_n_s32(value); }
+    
+    static Float add(Float a, Float b) noexcept { return vaddq_f32(a, b); }
+    static Float sub(Float a, Float b) noexcept { return vsubq_f32(a, b); }
+    static Float mul(Float a, Float b) noexcept { return vmulq_f32(a, b); }
+    static Float mulAdd(Float a, Float b, Float c) noexcept { return vmlaq_f32(c, a, b); }
+    static Float min(Float a, Float b) noexcept { return vminq_f32(a, b); }
+    static Float max(Float a, Float b) noexcept { return vmaxq_f32(a, b); }
+    static Float abs(Float x) noexcept { return vabsq_f32(x); }
+    static Float zeroUnlessGreater(Float x, Float value, Float threshold) noexcept
+    {
+        return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(x), vcgtq_f32(value, threshold)));
+    }
+    static Float pickIfGreater(Float value, Float threshold, Float x, Float otherwise) noexcept
+    {
+        return vbslq_f32(vcgtq_f32(value, threshold), x, otherwise);
+    }
+    
+    static Int truncate(Float x) noexcept { return vcvtq_s32_f32(x); }
+    static Float toFloat(Int i) noexcept { return vcvtq_f32_s32(i); }
+    static Int asInt(Float x) noexcept { return vreinterpretq_s32_f32(x); }
+    static Float asFloat(Int i) noexcept { return vreinterpretq_f32_s32(i); }
+    static Int andInt(Int a, Int b) noexcept { return vandq_s32(a, b); }
+    static Int orInt(Int a, Int b) noexcept { return vorrq_s32(a, b); }
+    static Int subInt(Int a, Int b) noexcept { return vsubq_s32(a, b); }
+    static Int exponentBits(Int i) noexcept { return vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(i), 23)); }
+    static Int toExponent(Int i) noexcept { return vshlq_n_s32(i, 23); }
+};
+#else
+using SIMDOps = ScalarOps;
+#endif
+
+//==============================================================================
+template<typename Ops, size_t N>
+typename Ops::Float evaluatePolynomial(const std::array<float, N>& coefficients, typename Ops::Float x) noexcept
+{
+    auto result = Ops::set(coefficients[N - 1]);
+    for ( auto i = N - 1; i > 0; --i )
+    {
+        result = Ops::mulAdd(result, x, Ops::set(coefficients[i - 1]));
+    }
+    
+    return result;
+}
+
+template<Accuracy accuracy, typename Ops>
+typename Ops::Float log2(typename Ops::Float x) noexcept
+{
+    auto bits = Ops::asInt(x);
+    auto exponent = Ops::toFloat(Ops::subInt(Ops::exponentBits(bits), Ops::setInt(127)));
+    
+    // the mantissa with the exponent of 1.0, i.e. in [1, 2)
+    auto mantissa = Ops::asFloat(Ops::orInt(Ops::andInt(bits, Ops::setInt(0x007fffff)), Ops::setInt(0x3f800000)));
+    auto t = Ops::sub(mantissa, Ops::set(1.f));
+    
+    return Ops::mulAdd(t, evaluatePolynomial<Ops>(Log2Coefficients<accuracy>::values, t), exponent);
+}
+
+template<Accuracy accuracy, typename Ops>
+typename Ops::Float exp2(typename Ops::Float x) noexcept
+{
+    x = Ops::max(Ops::min(x, Ops::set(127.f)), Ops::set(-126.f));
+    
+    // biasing first makes the input positive, so truncating rounds down and gives the exponent bits directly.
+    // The fraction is taken from the unbiased input so it doesn't lose the bits the bias pushed out.
+    auto exponent = Ops::truncate(Ops::add(x, Ops::set(127.f)));
+    auto f = Ops::sub(x, Ops::sub(Ops::toFloat(exponent), Ops::set(127.f)));
+    
+    auto mantissa = Ops::mulAdd(f, evaluatePolynomial<Ops>(Exp2Coefficients<accuracy>::values, f), Ops::set(1.f));
+    return Ops::mul(mantissa, Ops::asFloat(Ops::toExponent(exponent)));
+}
+
+template<typename Kernel>
+void apply(const float* src, float* dest, int numValues, Kernel kernel) noexcept
+{
+    auto i = 0;
+    for ( ; i + SIMDOps::width <= numValues; i += SIMDOps::width )
+    {
+        SIMDOps::store(dest + i, kernel(SIMDOps(), SIMDOps::load(src + i)));
+    }
+    
+    for ( ; i < numValues; ++i )
+    {
+        dest[i] = kernel(ScalarOps(), src[i]);
+    }
+}
+
+// 20 * log10(2) and its inverse
+constexpr float decibelsPerOctave = 6.02059991f;
+constexpr float octavesPerDecibel = 0.166096405f;
+
+}
+
+//==============================================================================
+// for kernels elsewhere that want to be written once for both (see ProcessingGraph)
+using ScalarOps = detail::ScalarOps;
+using SIMDOps = detail::SIMDOps;
+
+//==============================================================================
+template<Accuracy accuracy = Accuracy::Medium>
+float log2(float x) noexcept
+{
+    return detail::log2<accuracy, detail::ScalarOps>(x);
+}
+
+template<Accuracy accuracy = Accuracy::Medium>
+float exp2(float x) noexcept
+{
+    return detail::exp2<accuracy, detail::ScalarOps>(x);
+}
+
+template<Accuracy accuracy = Accuracy::Medium>
+void log2(const float* src, float* dest, int numValues) noexcept
+{
+    detail::apply(src, dest, numValues, [](auto ops, auto x)
+    {
+        return detail::log2<accuracy, decltype(ops)>(x);
+    });
+}
+
+template<Accuracy accuracy = Accuracy::Medium>
+void exp2(const float* src, float* dest, int numValues) noexcept
+{
+    detail::apply(src, dest, numValues, [](auto ops, auto x)
+    {
+        return detail::exp2<accuracy, decltype(ops)>(x);
+    });
+}
+
+//==============================================================================
+// These follow juce::Decibels: anything at or below minusInfinityDb is silence, in both directions.
+template<Accuracy accuracy = Accuracy::Medium>
+void gainsToDecibels(const float* gains, float* decibels, int numValues, float minusInfinityDb = -100.f) noexcept
+{
+    // clamping the gain first also keeps zeros, negatives and denormals away from log2
+    auto minGain = juce::Decibels::decibelsToGain(minusInfinityDb, minusInfinityDb - 1.f);
+    
+    detail::apply(gains, decibels, numValues, [minGain, minusInfinityDb](auto ops, auto x)
+    {
+        using Ops = decltype(ops);
+        x = Ops::max(x, Ops::set(minGain));
+        auto db = Ops::mul(detail::log2<accuracy, Ops>(x), Ops::set(detail::decibelsPerOctave));
+        return Ops::max(db, Ops::set(minusInfinityDb));
+    });
+}
+
+/*
+The same with a scale folded into the same pass (normalisation, window gain...).
+Powers are squared gains and convert with 10 log10 instead of 20, which saves taking square roots of FFT bins.
+*/
+template<Accuracy accuracy = Accuracy::Medium>
+void scaledGainsToDecibels(const float* gains, float* decibels, int numValues, float scale, float minusInfinityDb = -100.f) noexcept
+{
+    auto minGain = juce::Decibels::decibelsToGain(minusInfinityDb, minusInfinityDb - 1.f);
+    
+    detail::apply(gains, decibels, numValues, [scale, minGain, minusInfinityDb](auto ops, auto x)
+    {
+        using Ops = decltype(ops);
+        x = Ops::max(Ops::mul(x, Ops::set(scale)), Ops::set(minGain));
+        auto db = Ops::mul(detail::log2<accuracy, Ops>(x), Ops::set(detail::decibelsPerOctave));
+        return Ops::max(db, Ops::set(minusInfinityDb));
+    });
+}
+
+template<Accuracy accuracy = Accuracy::Medium>
+void scaledPowersToDecibels(const float* powers, float* decibels, int numValues, float scale, float minusInfinityDb = -100.f) noexcept
+{
+    auto minPower = juce::Decibels::decibelsToGain(minusInfinityDb * 2.f, minusInfinityDb * 2.f - 1.f);
+    
+    detail::apply(powers, decibels, numValues, [scale, minPower, minusInfinityDb](auto ops, auto x)
+    {
+        using Ops = decltype(ops);
+        x = Ops::max(Ops::mul(x, Ops::set(scale)), Ops::set(minPower));
+        auto db = Ops::mul(detail::log2<accuracy, Ops>(x), Ops::set(detail::decibelsPerOctave * 0.5f));
+        return Ops::max(db, Ops::set(minusInfinityDb));
+    });
+}
+
+template<Accuracy accuracy = Accuracy::Medium>
+void decibelsToGains(const float* decibels, float* gains, int numValues, float minusInfinityDb = -100.f) noexcept
+{
+    detail::apply(decibels, gains, numValues, [minusInfinityDb](auto ops, auto db)
+    {
+        using Ops = decltype(ops);
+        auto gain = detail::exp2<accuracy, Ops>(Ops::mul(db, Ops::set(detail::octavesPerDecibel)));
+        return Ops::zeroUnlessGreater(gain, db, Ops::set(minusInfinityDb));
+    });
+}
+
+template<Accuracy accuracy = Accuracy::Medium>
+float gainToDecibels(float gain, float minusInfinityDb = -100.f) noexcept
+{
+    float db;
+    gainsToDecibels<accuracy>(&gain, &db, 1, minusInfinityDb);
+    return db;
+}
+
+template<Accuracy accuracy = Accuracy::Medium>
+float decibelsToGain(float db, float minusInfinityDb = -100.f) noexcept
+{
+    float gain;
+    decibelsToGains<accuracy>(&db, &gain, 1, minusInfinityDb);
+    return gain;
+}
+
+}
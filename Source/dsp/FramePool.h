@@ -0,0 +1,124 @@
+/*
+  ==============================================================================
+  
+    FramePool.h
+    Created: 19 Oct 2026 4:02:31am
+    Author:  Matt Aiken
+  
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Fifo.h"
+
+//==============================================================================
+/*
+A fixed set of frames that are handed from one stage of a pipeline to the next by index instead of being copied.
+
+A stage acquire()s a free frame (which gives it the only reference), fills it in place, and passes the index on
+through a FrameQueue. Whoever ends up holding the index reads the frame in place and release()s it when done, which
+puts it back in the pool once nobody else has retained it. A frame is never written while anyone holds a reference,
+so a reader can keep one for as long as it likes (a component holding the path it paints, say) and the writer
+just uses another frame.
+
+Nothing allocates after prepare(), and a frame's storage stays with it from one use to the next, so once a frame
+has grown to the size it's used at, filling it again doesn't allocate either.
+acquire() can be called from one thread at a time, release() and retain() from any.
+*/
+template<typename T, size_t Size>
+struct FramePool
+{
+    // only while no frame is in use. prepareFrame(T&) is called for every frame
+    template<typename PrepareFrame>
+    void prepare(PrepareFrame&& prepareFrame)
+    {
+        for ( size_t i = 0; i < Size; ++i )
+        {
+            prepareFrame(frames[i]);
+            referenceCounts[i].store(0);
+        }
+    }
+    
+    // a free frame's index, holding one reference, or -1 if every frame is in use
+    int acquire() noexcept
+    {
+        for ( size_t i = 0; i < Size; ++i )
+        {
+            auto expected = 0;
+            if ( referenceCounts[i].compare_exchange_strong(expected, 1, std::memory_order_acquire) )
+                return static_cast<int>(i);
+        }
+        
+        return -1;
+    }
+    
+    void retain(int index) noexcept
+    {
+        jassert( referenceCounts[static_cast<size_t>(index)].load() > 0 );
+        referenceCounts[static_cast<size_t>(index)].fetch_add(1, std::memory_order_relaxed);
+    }
+    
+    void release(int index) noexcept
+    {
+        auto previous = referenceCounts[static_cast<size_t>(index)].fetch_sub(1, std::memory_order_acq_rel);
+        jassert( previous > 0 );
+        juce::ignoreUnused(previous);
+    }
+    
+    T& get(int index) noexcept { return frames[static_cast<size_t>(index)]; }
+    const T& get(int index) const noexcept { return frames[static_cast<size_t>(index)]; }
+private:
+    std::array<T, Size> frames;
+    std::array<std::atomic<int>, Size> referenceCounts {};
+};
+
+//==============================================================================
+/*
+Passes frame indices from one stage to the next. An index in the queue carries the reference its sender held,
+so the receiver releases it (or passes it on) when it's done with it.
+*/
+template<size_t Size>
+struct FrameQueue
+{
+    // false if the queue is full, in which case the caller still holds the reference
+    bool push(int index) noexcept { return indices.push(index); }
+    
+    // the oldest index waiting, or -1
+    int pull() noexcept
+    {
+        auto index = -1;
+        return indices.pull(index) ? index : -1;
+    }
+    
+    // the newest index waiting, or -1. everything older is released back to the pool
+    template<typename Pool>
+    int pullLatest(Pool& pool) noexcept
+    {
+        auto latest = -1;
+        for ( auto index = pull(); index >= 0; index = pull() )
+        {
+            if ( latest >= 0 )
+                pool.release(latest);
+            
+            latest = index;
+        }
+        
+        return latest;
+    }
+    
+    // releases everything waiting
+    template<typename Pool>
+    void clear(Pool& pool) noexcept
+    {
+        for ( auto index = pull(); index >= 0; index = pull() )
+        {
+            pool.release(index);
+        }
+    }
+    
+    int getNumAvailableForReading() const noexcept { return indices.getNumAvailableForReading(); }
+private:
+    Fifo<int, Size> indices;
+};
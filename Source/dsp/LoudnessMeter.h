@@ -0,0 +1,385 @@
+/*
+  ==============================================================================
+  
+    LoudnessMeter.h
+    Created: 18 Oct 2026 10:31:16pm
+    Author:  Matt Aiken
+  
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <numeric>
+#include "../Globals.h"
+
+//==============================================================================
+struct LoudnessValues
+{
+    float momentaryLufs { Globals::getNegativeInf() };
+    float shortTermLufs { Globals::getNegativeInf() };
+    float integratedLufs { Globals::getNegativeInf() };
+    float loudnessRangeLu { 0.f };
+};
+
+//==============================================================================
+/*
+ITU-R BS.1770 / EBU R128 loudness: momentary (400 ms), short-term (3 s), gated integrated loudness and loudness range.
+
+Per sample all the audio thread does is two K-weighting biquads and a square per channel.
+The squares are summed into 100 ms sub-blocks, and everything else happens once per sub-block:
+- the momentary and short-term windows are sums over the last 4 and 30 sub-blocks, kept up to date by adding the newest
+  and subtracting whatever drops out (and summed from scratch every time the ring wraps, so they can't drift)
+- every momentary value goes into a histogram for the integrated loudness, every short-term value into another one
+  for the loudness range. Both cover -70 to +10 LUFS (-70 is the absolute gate) in 0.1 LU bins, so memory doesn't grow
+  no matter how long it runs, and the gated results are read straight from the bins.
+
+Nothing allocates, so it can be reset and prepared without going near the heap on the audio thread.
+Both channels of a stereo bus get a weight of 1, a mono bus is measured as one channel.
+*/
+struct LoudnessMeter
+{
+    static constexpr size_t maxChannels = 2;
+    
+    void prepare(double sampleRate)
+    {
+        jassert( sampleRate > 0 );
+        
+        subBlockLength = juce::jmax(1, juce::roundToInt(sampleRate * 0.1));
+        
+        for ( auto& channel : channels )
+        {
+            channel.shelf = makeShelf(sampleRate);
+            channel.highPass = makeHighPass(sampleRate);
+        }
+        
+        reset();
+    }
+    
+    void reset()
+    {
+        for ( auto& channel : channels )
+        {
+            channel.shelf.reset();
+            channel.highPass.reset();
+        }
+        
+        subBlockEnergy = 0.0;
+        subBlockFill = 0;
+        subBlocks.fill(0.0);
+        subBlockWriteIndex = 0;
+        numSubBlocks = 0;
+        momentarySum = 0.0;
+        shortTermSum = 0.0;
+        
+        momentaryHistogram.clear();
+        shortTermHistogram.clear();
+        
+        values = LoudnessValues();
+        maxMomentaryLufs = Globals::getNegativeInf();
+        maxShortTermLufs = Globals::getNegativeInf();
+    }
+    
+    // from any thread, the audio thread resets before it processes the next block
+    void requestReset() noexcept { resetRequested.store(true); }
+    
+    template<typename BlockType>
+    void process(const BlockType& block) noexcept
+    {
+        if ( resetRequested.exchange(false) )
+            reset();
+        
+        const auto numChannels = juce::jmin(block.getNumChannels(), maxChannels);
+        const auto numSamples = block.getNumSamples();
+        
+        size_t start = 0;
+        while ( start < numSamples )
+        {
+            auto length = juce::jmin(numSamples - start, static_cast<size_t>(subBlockLength - subBlockFill));
+            
+            for ( size_t channel = 0; channel < numChannels; ++channel )
+            {
+                auto& filters = channels[channel];
+                const auto* data = block.getChannelPointer(channel) + start;
+                
+                auto sumOfSquares = 0.0;
+                for ( size_t i = 0; i < length; ++i )
+                {
+                    auto weighted = filters.highPass.process(filters.shelf.process(static_cast<double>(data[i])));
+                    sumOfSquares += weighted * weighted;
+                }
+                
+                subBlockEnergy += sumOfSquares;
+            }
+            
+            start += length;
+            subBlockFill += static_cast<int>(length);
+            
+            if ( subBlockFill == subBlockLength )
+                completeSubBlock();
+        }
+    }
+    
+    const LoudnessValues& getValues() const noexcept { return values; }
+    float getMaxMomentaryLufs() const noexcept { return maxMomentaryLufs; }
+    float getMaxShortTermLufs() const noexcept { return maxShortTermLufs; }
+    
+    //==============================================================================
+    struct Result
+    {
+        float integratedLufs, loudnessRangeLu, maxMomentaryLufs, maxShortTermLufs;
+    };
+    
+    // measures a whole buffer, for anything that isn't running on the audio thread
+    static Result measure(const juce::AudioBuffer<float>& buffer, double sampleRate)
+    {
+        juce::ScopedNoDenormals noDenormals;
+        
+        auto meter = std::make_unique<LoudnessMeter>();
+        meter->prepare(sampleRate);
+        meter->process(juce::dsp::AudioBlock<const float>(buffer));
+        
+        const auto& result = meter->getValues();
+        return { result.integratedLufs, result.loudnessRangeLu, meter->getMaxMomentaryLufs(), meter->getMaxShortTermLufs() };
+    }
+    
+    static float energyToLufs(double energy) noexcept
+    {
+        if ( energy <= 0.0 )
+            return Globals::getNegativeInf();
+        
+        return juce::jmax(Globals::getNegativeInf(), static_cast<float>(-0.691 + 10.0 * std::log10(energy)));
+    }
+
+private:
+    // transposed direct form II, in double since the high pass sits at 38 Hz
+    struct Biquad
+    {
+        double b0 { 1 }, b1 { 0 }, b2 { 0 }, a1 { 0 }, a2 { 0 };
+        double z1 { 0 }, z2 { 0 };
+        
+        double process(double x) noexcept
+        {
+            auto y = b0 * x + z1;
+            z1 = b1 * x - a1 * y + z2;
+            z2 = b2 * x - a2 * y;
+            return y;
+        }
+        
+        void reset() noexcept { z1 = z2 = 0.0; }
+    };
+    
+    // the two stages of the K-weighting filter from BS.1770, worked out for any sample rate
+    static Biquad makeShelf(double sampleRate)
+    {
+        const auto f0 = 1681.974450955533;
+        const auto gainDb = 3.999843853973347;
+        const auto q = 0.7071752369554196;
+        
+        auto k = std::tan(juce::MathConstants<double>::pi * f0 / sampleRate);
+        auto vh = std::pow(10.0, gainDb / 20.0);
+        auto vb = std::pow(vh, 0.4996667741545416);
+        auto a0 = 1.0 + k / q + k * k;
+        
+        Biquad shelf;
+        shelf.b0 = (vh + vb * k / q + k * k) / a0;
+        shelf.b1 = 2.0 * (k * k - vh) / a0;
+        shelf.b2 = (vh - vb * k / q + k * k) / a0;
+        shelf.a1 = 2.0 * (k * k - 1.0) / a0;
+        shelf.a2 = (1.0 - k / q + k * k) / a0;
+        return shelf;
+    }
+    
+    static Biquad makeHighPass(double sampleRate)
+    {
+        const auto f0 = 38.13547087602444;
+        const auto q = 0.5003270373238773;
+        
+        auto k = std::tan(juce::MathConstants<double>::pi * f0 / sampleRate);
+        auto a0 = 1.0 + k / q + k * k;
+        
+        Biquad highPass;
+        highPass.b0 = 1.0;
+        highPass.b1 = -2.0;
+        highPass.b2 = 1.0;
+        highPass.a1 = 2.0 * (k * k - 1.0) / a0;
+        highPass.a2 = (1.0 - k / q + k * k) / a0;
+        return highPass;
+    }
+    
+    //==============================================================================
+    struct Histogram
+    {
+        static constexpr float minLufs = -70.f;
+        static constexpr float binsPerLu = 10.f;
+        static constexpr size_t numBins = 800; // up to +10 LUFS, anything louder goes in the last bin
+        
+        void clear()
+        {
+            counts.fill(0);
+            energies.fill(0.0);
+            totalCount = 0;
+            totalEnergy = 0.0;
+        }
+        
+        // the absolute gate: anything quieter than -70 LUFS isn't counted at all
+        void add(double energy, float lufs) noexcept
+        {
+            if ( lufs < minLufs )
+                return;
+            
+            auto bin = getBin(lufs);
+            ++counts[bin];
+            energies[bin] += energy;
+            ++totalCount;
+            totalEnergy += energy;
+        }
+        
+        // the first bin at or above the gate relative to everything that passed the absolute gate
+        size_t getRelativeGateBin(float relativeGateLu) const noexcept
+        {
+            auto gate = energyToLufs(totalEnergy / static_cast<double>(totalCount)) + relativeGateLu;
+            auto bin = std::ceil((gate - minLufs) * binsPerLu);
+            return static_cast<size_t>(juce::jlimit(0.f, static_cast<float>(numBins - 1), bin));
+        }
+        
+        static size_t getBin(float lufs) noexcept
+        {
+            auto bin = static_cast<int>((lufs - minLufs) * binsPerLu);
+            return static_cast<size_t>(juce::jlimit(0, static_cast<int>(numBins) - 1, bin));
+        }
+        
+        static float getBinLufs(size_t bin) noexcept
+        {
+            return minLufs + (static_cast<float>(bin) + 0.5f) / binsPerLu;
+        }
+        
+        std::array<juce::uint32, numBins> counts { };
+        std::array<double, numBins> energies { };
+        juce::uint64 totalCount { 0 };
+        double totalEnergy { 0 };
+    };
+    
+    // integrated loudness: the mean energy of every 400 ms block within 10 LU of the absolutely gated mean
+    float computeIntegrated() const noexcept
+    {
+        const auto& histogram = momentaryHistogram;
+        if ( histogram.totalCount == 0 )
+            return Globals::getNegativeInf();
+        
+        juce::uint64 count = 0;
+        auto energy = 0.0;
+        for ( auto bin = histogram.getRelativeGateBin(-10.f); bin < Histogram::numBins; ++bin )
+        {
+            count += histogram.counts[bin];
+            energy += histogram.energies[bin];
+        }
+        
+        return count > 0 ? energyToLufs(energy / static_cast<double>(count)) : Globals::getNegativeInf();
+    }
+    
+    // EBU Tech 3342: the spread between the 10th and 95th percentile of the short-term values, gated 20 LU down
+    float computeLoudnessRange() const noexcept
+    {
+        const auto& histogram = shortTermHistogram;
+        if ( histogram.totalCount == 0 )
+            return 0.f;
+        
+        auto first = histogram.getRelativeGateBin(-20.f);
+        
+        juce::uint64 count = 0;
+        for ( auto bin = first; bin < Histogram::numBins; ++bin )
+            count += histogram.counts[bin];
+        
+        if ( count == 0 )
+            return 0.f;
+        
+        auto lowTarget = static_cast<double>(count) * 0.1;
+        auto highTarget = static_cast<double>(count) * 0.95;
+        auto low = first, high = first;
+        juce::uint64 cumulative = 0;
+        
+        for ( auto bin = first; bin < Histogram::numBins; ++bin )
+        {
+            if ( static_cast<double>(cumulative) <= lowTarget )
+                low = bin;
+            
+            cumulative += histogram.counts[bin];
+            
+            if ( static_cast<double>(cumulative) >= highTarget )
+            {
+                high = bin;
+                break;
+            }
+        }
+        
+        return Histogram::getBinLufs(high) - Histogram::getBinLufs(low);
+    }
+    
+    void completeSubBlock() noexcept
+    {
+        constexpr size_t momentaryLength = 4, shortTermLength = 30;
+        
+        auto energy = subBlockEnergy / static_cast<double>(subBlockLength);
+        subBlockEnergy = 0.0;
+        subBlockFill = 0;
+        
+        auto leavingShortTerm = subBlocks[subBlockWriteIndex];
+        auto leavingMomentary = subBlocks[(subBlockWriteIndex + shortTermLength - momentaryLength) % shortTermLength];
+        subBlocks[subBlockWriteIndex] = energy;
+        subBlockWriteIndex = (subBlockWriteIndex + 1) % shortTermLength;
+        ++numSubBlocks;
+        
+        if ( subBlockWriteIndex == 0 )
+        {
+            shortTermSum = std::accumulate(subBlocks.begin(), subBlocks.end(), 0.0);
+            momentarySum = std::accumulate(subBlocks.end() - momentaryLength, subBlocks.end(), 0.0);
+        }
+        else
+        {
+            shortTermSum += energy - leavingShortTerm;
+            momentarySum += energy - leavingMomentary;
+        }
+        
+        // until the windows have filled up they show what there is so far, only complete windows are gated
+        auto momentaryEnergy = momentarySum / static_cast<double>(juce::jmin(numSubBlocks, momentaryLength));
+        auto shortTermEnergy = shortTermSum / static_cast<double>(juce::jmin(numSubBlocks, shortTermLength));
+        values.momentaryLufs = energyToLufs(momentaryEnergy);
+        values.shortTermLufs = energyToLufs(shortTermEnergy);
+        
+        if ( numSubBlocks >= momentaryLength )
+        {
+            momentaryHistogram.add(momentaryEnergy, values.momentaryLufs);
+            values.integratedLufs = computeIntegrated();
+            maxMomentaryLufs = juce::jmax(maxMomentaryLufs, values.momentaryLufs);
+        }
+        
+        if ( numSubBlocks >= shortTermLength )
+        {
+            shortTermHistogram.add(shortTermEnergy, values.shortTermLufs);
+            values.loudnessRangeLu = computeLoudnessRange();
+            maxShortTermLufs = juce::jmax(maxShortTermLufs, values.shortTermLufs);
+        }
+    }
+    
+    struct ChannelFilters
+    {
+        Biquad shelf, highPass;
+    };
+    
+    std::array<ChannelFilters, maxChannels> channels;
+    
+    int subBlockLength { 4800 }, subBlockFill { 0 };
+    double subBlockEnergy { 0 };
+    
+    std::array<double, 30> subBlocks { };
+    size_t subBlockWriteIndex { 0 }, numSubBlocks { 0 };
+    double momentarySum { 0 }, shortTermSum { 0 };
+    
+    Histogram momentaryHistogram, shortTermHistogram;
+    
+    LoudnessValues values;
+    float maxMomentaryLufs { Globals::getNegativeInf() }, maxShortTermLufs { Globals::getNegativeInf() };
+    std::atomic<bool> resetRequested { false };
+};
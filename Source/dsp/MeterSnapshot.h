@@ -0,0 +1,65 @@
+/*
+  ==============================================================================
+  
+    MeterSnapshot.h
+    Created: 18 Oct 2026 9:40:51pm
+    Author:  Matt Aiken
+  
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Decibel.h"
+#include "LoudnessMeter.h"
+#include "../Globals.h"
+#include "../gui/BandLevel.h"
+
+//==============================================================================
+struct MeterValues
+{
+    Decibel<float> leftPeakDb { Globals::getNegativeInf() }, rightPeakDb { Globals::getNegativeInf() };
+    Decibel<float> leftRmsDb { Globals::getNegativeInf() }, rightRmsDb { Globals::getNegativeInf() };
+    Decibel<float> leftTruePeakDb { Globals::getNegativeInf() }, rightTruePeakDb { Globals::getNegativeInf() };
+    LoudnessValues loudness;
+};
+
+//==============================================================================
+// Everything the meters show for one processed block, in and out and every band, all from the same block
+struct MeterSnapshot
+{
+    MeterValues in, out;
+    std::array<BandLevel, Globals::getNumMaxBands()> bands;
+    juce::int64 samplePosition { 0 }; // samples processed since prepareToPlay, up to the end of this block
+    
+    // the loudest peaks and the deepest gain reduction of both, everything else from 'later'
+    static MeterSnapshot combine(const MeterSnapshot& earlier, const MeterSnapshot& later)
+    {
+        auto combined = later;
+        
+        auto holdPeaks = [](MeterValues& values, const MeterValues& other)
+        {
+            values.leftPeakDb = juce::jmax(values.leftPeakDb.getDb(), other.leftPeakDb.getDb());
+            values.rightPeakDb = juce::jmax(values.rightPeakDb.getDb(), other.rightPeakDb.getDb());
+            values.leftTruePeakDb = juce::jmax(values.leftTruePeakDb.getDb(), other.leftTruePeakDb.getDb());
+            values.rightTruePeakDb = juce::jmax(values.rightTruePeakDb.getDb(), other.rightTruePeakDb.getDb());
+        };
+        
+        holdPeaks(combined.in, earlier.in);
+        holdPeaks(combined.out, earlier.out);
+        
+        for ( size_t i = 0; i < combined.bands.size(); ++i )
+        {
+            auto& band = combined.bands[i];
+            const auto& other = earlier.bands[i];
+            band.peakInputLevelDb = juce::jmax(band.peakInputLevelDb, other.peakInputLevelDb);
+            band.peakOutputLevelDb = juce::jmax(band.peakOutputLevelDb, other.peakOutputLevelDb);
+            band.maxGainReductionDb = juce::jmin(band.maxGainReductionDb, other.maxGainReductionDb);
+        }
+        
+        return combined;
+    }
+};
+
+static_assert( std::is_trivially_copyable_v<MeterSnapshot>, "published through a SeqLockRing" );
@@ -0,0 +1,235 @@
+/*
+  ==============================================================================
+  
+    MultiResolutionAnalyzer.cpp
+    Created: 19 Oct 2026 12:21:45am
+    Author:  Matt Aiken
+  
+  ==============================================================================
+*/
+
+#include "MultiResolutionAnalyzer.h"
+
+//==============================================================================
+HalfBandDecimator::HalfBandDecimator()
+{
+    // windowed sinc with its cutoff at half the output's Nyquist. the even offsets land on the sinc's zeros
+    double sum = 0.0;
+    
+    for ( size_t j = 0; j < coefficients.size(); ++j )
+    {
+        auto offset = static_cast<double>(2 * j + 1);
+        auto t = juce::MathConstants<double>::pi * offset * 0.5;
+        auto x = juce::MathConstants<double>::twoPi * (centre + offset) / (numTaps - 1);
+        auto blackman = 0.42 - 0.5 * std::cos(x) + 0.08 * std::cos(2.0 * x);
+        
+        auto c = 0.5 * std::sin(t) / t * blackman;
+        coefficients[j] = static_cast<float>(c);
+        sum += 2.0 * c;
+    }
+    
+    // unity at DC: the centre tap is 0.5, the rest have to add up to the other half
+    for ( auto& c : coefficients )
+        c = static_cast<float>(c * 0.5 / sum);
+}
+
+void HalfBandDecimator::prepare(int maximumInputSize)
+{
+    history.assign(static_cast<size_t>(historyLength + maximumInputSize), 0.f);
+    phase = 0;
+}
+
+void HalfBandDecimator::reset()
+{
+    std::fill(history.begin(), history.end(), 0.f);
+    phase = 0;
+}
+
+int HalfBandDecimator::process(const float* input, int numSamples, float* output) noexcept
+{
+    jassert( historyLength + numSamples <= static_cast<int>(history.size()) );
+    
+    std::copy(input, input + numSamples, history.begin() + historyLength);
+    
+    auto numOutputs = 0;
+    for ( auto i = phase; i < numSamples; i += 2 )
+    {
+        // history[historyLength + i] is input[i], the filter's centre is 'centre' samples before it
+        const auto* middle = history.data() + historyLength + i - centre;
+        auto y = 0.5f * middle[0];
+        
+        for ( size_t j = 0; j < coefficients.size(); ++j )
+        {
+            auto offset = static_cast<int>(2 * j + 1);
+            y += coefficients[j] * (middle[-offset] + middle[offset]);
+        }
+        
+        output[numOutputs++] = y;
+    }
+    
+    phase = (phase + numSamples) & 1;
+    std::copy(history.begin() + numSamples, history.begin() + numSamples + historyLength, history.begin());
+    
+    return numOutputs;
+}
+
+//==============================================================================
+void MultiResolutionAnalyzer::prepare(double sampleRate, int maximumPushSize)
+{
+    jassert( sampleRate > 0.0 );
+    
+    fft.changeOrder(levelOrder);
+    const auto fftSize = fft.getFFTSize();
+    const auto numBins = fft.getNumBins();
+    
+    // down to a lowest level running at a kilohertz and a half or so
+    auto octavesAboveLowest = std::log2(juce::jmax(sampleRate, 1500.0) / 1500.0);
+    auto numLevels = juce::jlimit(1, 8, 1 + static_cast<int>(std::floor(octavesAboveLowest)));
+    levels = std::vector<Level>(static_cast<size_t>(numLevels));
+    
+    /*
+    Level k's decimator is clean up to 0.4 of its rate, so that's where it hands over to the level above.
+    In bins that's the same for every level, and the level above picks up at half of it in its own (twice as wide) bins.
+    The top level goes all the way to Nyquist, the bottom one all the way down.
+    */
+    const auto cleanBins = static_cast<int>(std::ceil(0.4 * fftSize));
+    
+    auto inputSize = maximumPushSize;
+    for ( auto k = 0; k < numLevels; ++k )
+    {
+        auto& level = levels[static_cast<size_t>(k)];
+        
+        if ( k > 0 )
+        {
+            for ( auto& decimator : level.decimators )
+                decimator.prepare(inputSize);
+            
+            inputSize = (inputSize + 1) / 2;
+        }
+        
+        level.window.setSize(2, fftSize);
+        level.window.clear();
+        level.writeIndex = 0;
+        level.spectrum.assign(static_cast<size_t>((numBins + 1) * 2), Globals::getNegativeInf());
+        
+        level.endBin = k == 0 ? numBins + 1 : cleanBins;
+        level.firstBin = k == numLevels - 1 ? 0 : (cleanBins + 1) / 2;
+    }
+    
+    for ( auto& buffer : decimated )
+        buffer.setSize(2, (maximumPushSize + 1) / 2);
+    
+    unwrappedWindow.setSize(2, fftSize);
+    
+    // lowest level first, so the frequencies come out in order
+    binFrequencies.clear();
+    for ( auto k = numLevels - 1; k >= 0; --k )
+    {
+        const auto& level = levels[static_cast<size_t>(k)];
+        auto binWidth = sampleRate / std::exp2(k) / fftSize;
+        
+        for ( auto bin = level.firstBin; bin < level.endBin; ++bin )
+            binFrequencies.push_back(static_cast<float>(bin * binWidth));
+    }
+    
+    frame.assign(binFrequencies.size() * 2, Globals::getNegativeInf());
+    numAnalyses = 0;
+}
+
+void MultiResolutionAnalyzer::reset()
+{
+    for ( auto& level : levels )
+    {
+        for ( auto& decimator : level.decimators )
+            decimator.reset();
+        
+        level.window.clear();
+        level.writeIndex = 0;
+    }
+    
+    numAnalyses = 0;
+}
+
+int MultiResolutionAnalyzer::getHistoryLength() const
+{
+    return fft.getFFTSize() << (getNumLevels() - 1);
+}
+
+void MultiResolutionAnalyzer::push(const float* left, const float* right, int numSamples) noexcept
+{
+    std::array<const float*, 2> input { left, right };
+    
+    for ( size_t k = 0; k < levels.size(); ++k )
+    {
+        auto& level = levels[k];
+        auto numInputs = numSamples;
+        
+        if ( k > 0 )
+        {
+            auto& output = decimated[k & 1];
+            for ( auto channel = 0; channel < 2; ++channel )
+            {
+                numSamples = level.decimators[static_cast<size_t>(channel)].process(input[static_cast<size_t>(channel)], numInputs, output.getWritePointer(channel));
+                input[static_cast<size_t>(channel)] = output.getReadPointer(channel);
+            }
+        }
+        
+        // into the circular window, in at most two runs
+        const auto fftSize = level.window.getNumSamples();
+        auto toWrite = juce::jmin(numSamples, fftSize);
+        auto skipped = numSamples - toWrite;
+        auto firstRun = juce::jmin(toWrite, fftSize - level.writeIndex);
+        
+        for ( auto channel = 0; channel < 2; ++channel )
+        {
+            const auto* source = input[static_cast<size_t>(channel)] + skipped;
+            juce::FloatVectorOperations::copy(level.window.getWritePointer(channel, level.writeIndex), source, firstRun);
+            juce::FloatVectorOperations::copy(level.window.getWritePointer(channel, 0), source + firstRun, toWrite - firstRun);
+        }
+        
+        level.writeIndex = (level.writeIndex + toWrite) % fftSize;
+    }
+}
+
+void MultiResolutionAnalyzer::analyze()
+{
+    const auto fftSize = fft.getFFTSize();
+    
+    for ( size_t k = 0; k < levels.size(); ++k )
+    {
+        // level k's audio moves half as fast as level k - 1's, so it only needs a new transform half as often
+        if ( (numAnalyses & ((juce::int64(1) << k) - 1)) != 0 )
+            continue;
+        
+        auto& level = levels[k];
+        auto olderRun = fftSize - level.writeIndex;
+        
+        for ( auto channel = 0; channel < 2; ++channel )
+        {
+            auto* destination = unwrappedWindow.getWritePointer(channel);
+            juce::FloatVectorOperations::copy(destination, level.window.getReadPointer(channel, level.writeIndex), olderRun);
+            juce::FloatVectorOperations::copy(destination + olderRun, level.window.getReadPointer(channel, 0), level.writeIndex);
+        }
+        
+        fft.transformStereo(unwrappedWindow.getReadPointer(0), unwrappedWindow.getReadPointer(1), level.spectrum.data());
+    }
+    
+    ++numAnalyses;
+    
+    // lowest level first, the same order as binFrequencies
+    const auto numBins = fft.getNumBins();
+    auto* left = frame.data();
+    auto* right = frame.data() + binFrequencies.size();
+    
+    for ( auto k = getNumLevels() - 1; k >= 0; --k )
+    {
+        const auto& level = levels[static_cast<size_t>(k)];
+        auto count = level.endBin - level.firstBin;
+        
+        std::copy_n(level.spectrum.data() + level.firstBin, count, left);
+        std::copy_n(level.spectrum.data() + numBins + 1 + level.firstBin, count, right);
+        
+        left += count;
+        right += count;
+    }
+}
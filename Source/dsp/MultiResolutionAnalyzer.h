@@ -0,0 +1,100 @@
+/*
+  ==============================================================================
+  
+    MultiResolutionAnalyzer.h
+    Created: 19 Oct 2026 12:21:45am
+    Author:  Matt Aiken
+  
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FFTDataGenerator.h"
+#include "../Globals.h"
+
+//==============================================================================
+/*
+Halves the sample rate: a 55 tap half-band lowpass, evaluated only at the samples that are kept.
+Every other tap of a half-band filter is zero, so each output costs 14 multiplies (the taps are symmetric too).
+Flat to a fifth of the input rate and down more than 70 dB from 0.3 of it, which is as much as the analyzer uses.
+*/
+struct HalfBandDecimator
+{
+    HalfBandDecimator();
+    
+    // allocates, maximumInputSize is the most process() gets at once
+    void prepare(int maximumInputSize);
+    void reset();
+    
+    // returns how many samples went to output, which needs room for (numSamples + 1) / 2
+    int process(const float* input, int numSamples, float* output) noexcept;
+private:
+    static constexpr int numTaps = 55;
+    static constexpr int centre = (numTaps - 1) / 2;
+    static constexpr int historyLength = numTaps - 1;
+    
+    std::array<float, (centre + 1) / 2> coefficients; // for the odd offsets from the centre, 1, 3, 5...
+    std::vector<float> history;
+    int phase { 0 }; // whether the next input sample is kept
+};
+
+//==============================================================================
+/*
+A constant-Q-ish analyzer built from small FFTs.
+
+The input goes through a cascade of half-band decimators, so level k sees the audio at sampleRate / 2^k,
+and every level runs the same 2048 point stereo FFT. Each level only shows the octave just below the part of its
+band the decimator leaves clean, so from the top down the display gets 23 Hz bins, then 12, 6, 3... at 48 kHz
+the lowest level's bins are 0.7 Hz, finer than an 8192 point FFT by a factor of eight.
+
+Level k's audio only moves on by half as much as level k - 1's, so it's only transformed every 2^k frames:
+all of the levels together cost about two 2048 point FFTs per frame, against one 8192 point FFT for the single one.
+The decimators add about one FIR per input sample, whatever the number of levels.
+
+Every level's latest spectrum is stitched into one frame of ascending (not evenly spaced) bins.
+*/
+struct MultiResolutionAnalyzer
+{
+    static constexpr FFTOrder levelOrder = order2048;
+    
+    // allocates, maximumPushSize is the most push() gets at once
+    void prepare(double sampleRate, int maximumPushSize);
+    void reset();
+    
+    int getNumLevels() const { return static_cast<int>(levels.size()); }
+    
+    // the audio it takes (at the input rate) to fill every level's window
+    int getHistoryLength() const;
+    
+    // the next numSamples of left and right
+    void push(const float* left, const float* right, int numSamples) noexcept;
+    
+    // transforms the levels that are due and stitches everything into the frame
+    void analyze();
+    
+    // the bins' centre frequencies, in ascending order. the same for both channels
+    const std::vector<float>& getBinFrequencies() const { return binFrequencies; }
+    int getNumBins() const { return static_cast<int>(binFrequencies.size()); }
+    
+    // decibels, left then right, getNumBins() each
+    const std::vector<float>& getFrame() const { return frame; }
+private:
+    struct Level
+    {
+        std::array<HalfBandDecimator, 2> decimators; // the ones feeding this level, level 0 doesn't use them
+        juce::AudioBuffer<float> window;             // circular, the last fftSize samples
+        int writeIndex { 0 };
+        std::vector<float> spectrum;                 // the last transform, left then right
+        int firstBin { 0 }, endBin { 0 };            // the part of it that goes on the display
+    };
+    
+    std::vector<Level> levels;
+    FFTDataGenerator fft;
+    juce::AudioBuffer<float> unwrappedWindow;
+    std::array<juce::AudioBuffer<float>, 2> decimated; // ping-pong between levels, one channel each side
+    
+    std::vector<float> binFrequencies, frame;
+    juce::int64 numAnalyses { 0 };
+};
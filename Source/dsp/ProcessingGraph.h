@@ -0,0 +1,140 @@
+/*
+  ==============================================================================
+  
+    ProcessingGraph.h
+    Created: 18 Oct 2026 7:21:40pm
+    Author:  Matt Aiken
+  
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FastMath.h"
+
+//==============================================================================
+/*
+A processing chain is put together from stages at compile time.
+
+Elementwise stages only ever look at one sample at a time, written once for scalar and SIMD registers:
+
+    void beginBlock(size_t numChannels, size_t numSamples);
+    void beginChannel(size_t channel);
+    template<typename Ops> typename Ops::Float process(typename Ops::Float x, size_t index); // index of the first sample in x
+    void endChannel(size_t channel);
+    void endBlock();
+
+Block stages need the whole block at once (filters, the band split):
+
+    void processBlock(juce::dsp::AudioBlock<float>& block);
+
+Each run of adjacent elementwise stages is fused into a single kernel: every channel is loaded a register at a time
+(four samples on SSE2 / NEON), passes through all of the stages in the run and is stored once.
+Reordering or adding stages only means changing the chain's list of stages.
+*/
+namespace ProcessingGraph
+{
+
+struct ElementwiseStage
+{
+    static constexpr bool isElementwise = true;
+    
+    void beginBlock(size_t, size_t) noexcept { }
+    void beginChannel(size_t) noexcept { }
+    void endChannel(size_t) noexcept { }
+    void endBlock() noexcept { }
+};
+
+struct BlockStage
+{
+    static constexpr bool isElementwise = false;
+};
+
+//==============================================================================
+template<typename... Stages>
+struct Chain
+{
+    explicit Chain(Stages&... s) : stages(s...) { }
+    
+    void process(juce::dsp::AudioBlock<float>& block)
+    {
+        processFrom<0>(block);
+    }
+
+private:
+    static constexpr size_t numStages = sizeof...(Stages);
+    static constexpr std::array<bool, numStages> elementwise { Stages::isElementwise... };
+    
+    // one past the last stage of the elementwise run starting at 'first'
+    static constexpr size_t findEndOfRun(size_t first)
+    {
+        auto end = first;
+        while ( end < numStages && elementwise[end] )
+            ++end;
+        
+        return end;
+    }
+    
+    template<size_t Index>
+    void processFrom(juce::dsp::AudioBlock<float>& block)
+    {
+        if constexpr ( Index < numStages )
+        {
+            if constexpr ( elementwise[Index] )
+            {
+                constexpr auto end = findEndOfRun(Index);
+                processFused(block, std::make_index_sequence<end - Index>(), std::integral_constant<size_t, Index>());
+                processFrom<end>(block);
+            }
+            else
+            {
+                std::get<Index>(stages).processBlock(block);
+                processFrom<Index + 1>(block);
+            }
+        }
+    }
+    
+    template<size_t... Offsets, size_t First>
+    void processFused(juce::dsp::AudioBlock<float>& block, std::index_sequence<Offsets...>, std::integral_constant<size_t, First>)
+    {
+        using VectorOps = FastMath::SIMDOps;
+        using ScalarOps = FastMath::ScalarOps;
+        constexpr auto width = static_cast<size_t>(VectorOps::width);
+        
+        const auto numChannels = block.getNumChannels();
+        const auto numSamples = block.getNumSamples();
+        
+        (std::get<First + Offsets>(stages).beginBlock(numChannels, numSamples), ...);
+        
+        for ( size_t channel = 0; channel < numChannels; ++channel )
+        {
+            (std::get<First + Offsets>(stages).beginChannel(channel), ...);
+            
+            auto* data = block.getChannelPointer(channel);
+            
+            size_t i = 0;
+            for ( ; i + width <= numSamples; i += width )
+            {
+                auto x = VectorOps::load(data + i);
+                ((x = std::get<First + Offsets>(stages).template process<VectorOps>(x, i)), ...);
+                VectorOps::store(data + i, x);
+            }
+            
+            for ( ; i < numSamples; ++i )
+            {
+                auto x = data[i];
+                ((x = std::get<First + Offsets>(stages).template process<ScalarOps>(x, i)), ...);
+                data[i] = x;
+            }
+            
+            (std::get<First + Offsets>(stages).endChannel(channel), ...);
+        }
+        
+        (std::get<First + Offsets>(stages).endBlock(), ...);
+    }
+    
+    std::tuple<Stages&...> stages;
+};
+
+}
@@ -0,0 +1,322 @@
+/*
+  ==============================================================================
+  
+    ProcessingStages.h
+    Created: 18 Oct 2026 7:48:05pm
+    Author:  Matt Aiken
+  
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ProcessingGraph.h"
+#include "Decibel.h"
+#include "LoudnessMeter.h"
+#include "TruePeakDetector.h"
+#include "AnalysisRing.h"
+#include "../Channel.h"
+
+//==============================================================================
+// Smoothed gain, so moving the gain knobs doesn't zipper
+struct GainStage : ProcessingGraph::ElementwiseStage
+{
+    void prepare(const juce::dsp::ProcessSpec& spec, double rampSeconds = 0.05)
+    {
+        gain.reset(spec.sampleRate, rampSeconds);
+        gain.setCurrentAndTargetValue(gain.getTargetValue());
+        ramp.assign(spec.maximumBlockSize, 1.f);
+    }
+    
+    void setGainDecibels(float newGainDb)
+    {
+        gain.setTargetValue(juce::Decibels::decibelsToGain(newGainDb));
+    }
+    
+    // the ramp is worked out once per block, not once per channel, and only while the gain is actually moving
+    void beginBlock(size_t, size_t numSamples) noexcept
+    {
+        ramping = gain.isSmoothing();
+        
+        if ( ramping && numSamples > ramp.size() )
+        {
+            // more samples than prepared for, jump to wherever the ramp would have ended up
+            jassertfalse;
+            gain.skip(static_cast<int>(numSamples));
+            ramping = false;
+        }
+        
+        if ( ramping )
+        {
+            for ( size_t i = 0; i < numSamples; ++i )
+            {
+                ramp[i] = gain.getNextValue();
+            }
+        }
+        
+        current = gain.getCurrentValue();
+        unity = !ramping && current == 1.f;
+    }
+    
+    template<typename Ops>
+    typename Ops::Float process(typename Ops::Float x, size_t index) noexcept
+    {
+        if ( unity )
+            return x;
+        
+        if ( ramping )
+            return Ops::mul(x, Ops::load(ramp.data() + index));
+        
+        return Ops::mul(x, Ops::set(current));
+    }
+
+private:
+    juce::SmoothedValue<float> gain { 1.f };
+    std::vector<float> ramp;
+    float current { 1.f };
+    bool ramping { false }, unity { true };
+};
+
+//==============================================================================
+// Peak, 4x oversampled true peak and RMS per channel, written to the destination as decibels once per block
+template<typename ValuesType>
+struct LevelMeterStage : ProcessingGraph::ElementwiseStage
+{
+    explicit LevelMeterStage(ValuesType& valuesDestination) : destination(valuesDestination) { }
+    
+    void prepare(const juce::dsp::ProcessSpec& spec)
+    {
+        for ( auto& detector : truePeakDetectors )
+        {
+            detector.prepare(static_cast<int>(spec.maximumBlockSize));
+        }
+    }
+    
+    // a disabled meter doesn't look at the samples and leaves the destination alone
+    void setEnabled(bool shouldBeEnabled) { enabled = shouldBeEnabled; }
+    
+    void beginBlock(size_t numChannels, size_t numSamples) noexcept
+    {
+        jassert( numChannels <= peaks.size() );
+        peaks.fill(0.f);
+        truePeaks.fill(0.f);
+        sumsOfSquares.fill(0.0);
+        blockChannels = numChannels;
+        blockSize = enabled ? numSamples : 0;
+        
+        // a host that goes over the block size it promised only gets sample peaks for that block
+        measureTruePeak = enabled && static_cast<int>(numSamples) <= truePeakDetectors[0].getCapacity();
+    }
+    
+    void beginChannel(size_t channel) noexcept
+    {
+        vectorAccumulators.reset();
+        scalarAccumulators.reset();
+        
+        truePeakInput = measureTruePeak && channel < truePeakDetectors.size() ? truePeakDetectors[channel].getInputPointer()
+                                                                                : nullptr;
+    }
+    
+    template<typename Ops>
+    typename Ops::Float process(typename Ops::Float x, size_t index) noexcept
+    {
+        if ( enabled )
+        {
+            auto& accumulators = getAccumulators<Ops>();
+            accumulators.peak = Ops::max(accumulators.peak, Ops::abs(x));
+            accumulators.sumOfSquares = Ops::mulAdd(x, x, accumulators.sumOfSquares);
+        }
+        
+        // the interpolator runs over the whole channel at the end, it just needs the samples as the meter saw them
+        if ( truePeakInput != nullptr )
+            Ops::store(truePeakInput + index, x);
+        
+        return x;
+    }
+    
+    // the lanes are only added up once per channel
+    void endChannel(size_t channel) noexcept
+    {
+        if ( !enabled || channel >= peaks.size() )
+            return;
+        
+        std::array<float, FastMath::SIMDOps::width> lanePeaks, laneSums;
+        FastMath::SIMDOps::store(lanePeaks.data(), vectorAccumulators.peak);
+        FastMath::SIMDOps::store(laneSums.data(), vectorAccumulators.sumOfSquares);
+        
+        auto peak = scalarAccumulators.peak;
+        auto sumOfSquares = static_cast<double>(scalarAccumulators.sumOfSquares);
+        for ( size_t lane = 0; lane < lanePeaks.size(); ++lane )
+        {
+            peak = juce::jmax(peak, lanePeaks[lane]);
+            sumOfSquares += static_cast<double>(laneSums[lane]);
+        }
+        
+        peaks[channel] = peak;
+        sumsOfSquares[channel] = sumOfSquares;
+        
+        truePeaks[channel] = truePeakInput != nullptr
+                           ? juce::jmax(peak, truePeakDetectors[channel].processBlock(static_cast<int>(blockSize)))
+                           : peak;
+    }
+    
+    void endBlock()
+    {
+        if ( blockSize == 0 )
+            return;
+        
+        auto rms = [this](size_t channel)
+        {
+            return static_cast<float>(std::sqrt(sumsOfSquares[channel] / static_cast<double>(blockSize)));
+        };
+        
+        // a mono bus shows the same level on both sides
+        auto right = blockChannels > 1 ? size_t(1) : size_t(0);
+        std::array<float, 6> levels { peaks[0], peaks[right], rms(0), rms(right), truePeaks[0], truePeaks[right] };
+        Decibel<float>::gainsToDecibels(levels.data(), levels.data(), static_cast<int>(levels.size()));
+        
+        destination.leftPeakDb = levels[0];
+        destination.rightPeakDb = levels[1];
+        destination.leftRmsDb = levels[2];
+        destination.rightRmsDb = levels[3];
+        destination.leftTruePeakDb = levels[4];
+        destination.rightTruePeakDb = levels[5];
+    }
+
+private:
+    template<typename Ops>
+    struct Accumulators
+    {
+        typename Ops::Float peak, sumOfSquares;
+        
+        void reset() noexcept
+        {
+            peak = Ops::set(0.f);
+            sumOfSquares = Ops::set(0.f);
+        }
+    };
+    
+    // without SIMD both kinds of ops are the same, and everything ends up in the scalar accumulators
+    template<typename Ops>
+    Accumulators<Ops>& getAccumulators() noexcept
+    {
+        if constexpr ( std::is_same_v<Ops, FastMath::ScalarOps> )
+            return scalarAccumulators;
+        else
+            return vectorAccumulators;
+    }
+    
+    ValuesType& destination;
+    Accumulators<FastMath::SIMDOps> vectorAccumulators;
+    Accumulators<FastMath::ScalarOps> scalarAccumulators;
+    std::array<float, 2> peaks { }, truePeaks { };
+    std::array<double, 2> sumsOfSquares { };
+    std::array<TruePeakDetector, 2> truePeakDetectors;
+    float* truePeakInput { nullptr };
+    size_t blockChannels { 0 }, blockSize { 0 };
+    bool enabled { true }, measureTruePeak { false };
+};
+
+//==============================================================================
+// Writes left and right (or the one channel to both for mono) into the analysis ring
+struct AnalyzerTapStage : ProcessingGraph::ElementwiseStage
+{
+    explicit AnalyzerTapStage(AnalysisRing& analysisRing) : ring(analysisRing) { }
+    
+    void prepare(const juce::dsp::ProcessSpec& spec)
+    {
+        staging.assign(spec.maximumBlockSize, 0.f);
+    }
+    
+    void setEnabled(bool shouldBeEnabled) { enabled = shouldBeEnabled; }
+    
+    void beginBlock(size_t numChannels, size_t numSamples) noexcept
+    {
+        mono = numChannels == 1;
+        blockSize = numSamples;
+        staged = numSamples <= staging.size();
+    }
+    
+    void beginChannel(size_t channel) noexcept
+    {
+        currentChannel = channel;
+    }
+    
+    // the samples are collected here and go into the ring as one run per channel
+    template<typename Ops>
+    typename Ops::Float process(typename Ops::Float x, size_t index) noexcept
+    {
+        if ( !enabled || currentChannel > 1 )
+            return x;
+        
+        if ( staged )
+        {
+            Ops::store(staging.data() + index, x);
+        }
+        else
+        {
+            // a block bigger than the host promised goes over a register at a time
+            std::array<float, Ops::width> samples;
+            Ops::store(samples.data(), x);
+            write(samples.data(), samples.size(), index);
+        }
+        
+        return x;
+    }
+    
+    void endChannel(size_t) noexcept
+    {
+        if ( enabled && currentChannel <= 1 && staged )
+            write(staging.data(), blockSize, 0);
+    }
+    
+    // every channel is in, so the analyzers can have the block
+    void endBlock() noexcept
+    {
+        if ( enabled )
+            ring.advance(static_cast<int>(blockSize));
+    }
+
+private:
+    void write(const float* samples, size_t numSamples, size_t offset) noexcept
+    {
+        ring.write(static_cast<int>(currentChannel), samples, static_cast<int>(numSamples), static_cast<int>(offset));
+        
+        if ( mono )
+            ring.write(Channel::Right, samples, static_cast<int>(numSamples), static_cast<int>(offset));
+    }
+    
+    AnalysisRing& ring;
+    std::vector<float> staging;
+    size_t blockSize { 0 }, currentChannel { 0 };
+    bool enabled { false }, mono { false }, staged { false };
+};
+
+//==============================================================================
+// K-weighted loudness, written to the destination after every block
+template<typename ValuesType>
+struct LoudnessStage : ProcessingGraph::BlockStage
+{
+    explicit LoudnessStage(ValuesType& valuesDestination) : destination(valuesDestination) { }
+    
+    void prepare(const juce::dsp::ProcessSpec& spec) { meter.prepare(spec.sampleRate); }
+    
+    // switching back on carries on from where it stopped, only requestReset() starts the measurement over
+    void setEnabled(bool shouldBeEnabled) { enabled = shouldBeEnabled; }
+    void requestReset() noexcept { meter.requestReset(); }
+    
+    void processBlock(juce::dsp::AudioBlock<float>& block) noexcept
+    {
+        if ( !enabled )
+            return;
+        
+        meter.process(block);
+        destination.loudness = meter.getValues();
+    }
+
+private:
+    ValuesType& destination;
+    LoudnessMeter meter;
+    bool enabled { true };
+};
@@ -0,0 +1,117 @@
+/*
+  ==============================================================================
+  
+    RunningMeanSquare.h
+    Created: 18 Oct 2026 2:41:09pm
+    Author:  Matt Aiken
+  
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+Mean square over a sliding window, updated in O(1) per sample regardless of the window length.
+
+The squares are kept in a preallocated history and summed as fixed point integers (40 fractional bits),
+so the value added for a sample and the value subtracted when it leaves the window cancel exactly and the
+running sum can't drift, no matter how long it runs for.
+*/
+template<typename SampleType>
+struct RunningMeanSquare
+{
+    void prepare(int maxWindowLength)
+    {
+        jassert( maxWindowLength > 0 );
+        
+        history.assign(static_cast<size_t>(maxWindowLength), static_cast<SampleType>(0));
+        
+        // leave enough headroom that a full window of the largest square still fits in 63 bits
+        auto capacityBits = 0;
+        while ( (1 << capacityBits) < maxWindowLength )
+            ++capacityBits;
+        
+        jassert( capacityBits < 23 );
+        maxSquare = static_cast<SampleType>(std::ldexp(1.0, 63 - getFractionalBits() - capacityBits));
+        
+        windowLength = juce::jmin(windowLength, maxWindowLength);
+        reset();
+    }
+    
+    void reset()
+    {
+        std::fill(history.begin(), history.end(), static_cast<SampleType>(0));
+        sum = 0;
+        writeIndex = 0;
+    }
+    
+    int getMaxWindowLength() const { return static_cast<int>(history.size()); }
+    int getWindowLength() const { return windowLength; }
+    
+    // the window grows or shrinks over the history that's already there, so changing it doesn't cause a dip
+    void setWindowLength(int numSamples)
+    {
+        jassert( !history.empty() );
+        numSamples = juce::jlimit(1, getMaxWindowLength(), numSamples);
+        
+        while ( windowLength < numSamples )
+        {
+            ++windowLength;
+            sum += quantise(history[getOldestIndex()]);
+        }
+        
+        while ( windowLength > numSamples )
+        {
+            sum -= quantise(history[getOldestIndex()]);
+            --windowLength;
+        }
+    }
+    
+    void push(SampleType sample) noexcept
+    {
+        auto square = juce::jmin(sample * sample, maxSquare);
+        
+        // when the window spans the whole history the sample leaving is the one about to be overwritten
+        sum -= quantise(history[getOldestIndex()]);
+        history[static_cast<size_t>(writeIndex)] = square;
+        sum += quantise(square);
+        
+        if ( ++writeIndex == getMaxWindowLength() )
+            writeIndex = 0;
+    }
+    
+    SampleType getMeanSquare() const noexcept
+    {
+        auto meanSquare = static_cast<double>(sum) / (getScale() * static_cast<double>(windowLength));
+        return static_cast<SampleType>(meanSquare);
+    }
+    
+    SampleType getRMS() const noexcept
+    {
+        return std::sqrt(getMeanSquare());
+    }
+
+private:
+    static constexpr int getFractionalBits() { return 40; }
+    static constexpr double getScale() { return static_cast<double>(juce::uint64(1) << getFractionalBits()); }
+    
+    static juce::uint64 quantise(SampleType square) noexcept
+    {
+        return static_cast<juce::uint64>(static_cast<double>(square) * getScale());
+    }
+    
+    int getOldestIndex() const noexcept
+    {
+        auto index = writeIndex - windowLength;
+        return index < 0 ? index + getMaxWindowLength() : index;
+    }
+    
+    std::vector<SampleType> history;
+    juce::uint64 sum { 0 };
+    int writeIndex { 0 };
+    int windowLength { 1 };
+    SampleType maxSquare { 1 };
+};
@@ -0,0 +1,144 @@
+/*
+  ==============================================================================
+  
+    SeqLockRing.h
+    Created: 18 Oct 2026 9:12:27pm
+    Author:  Matt Aiken
+  
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <cstring>
+
+//==============================================================================
+/*
+A lock-free ring of the last Capacity values written by one thread, for any number of readers.
+
+The writer never waits and never fails: the oldest value is simply overwritten.
+Every slot is a seqlock. Its sequence number says which write it holds and whether that write is still in progress,
+so a reader can tell when the writer lapped it in the middle of a read and just skips that value.
+The values are copied through relaxed atomic words, so a torn read is detected rather than being a data race.
+
+readLatest() is a latest-value mailbox. readSince() lets a reader that fell behind go through every value
+it hasn't seen yet, as long as it's no more than Capacity writes behind.
+*/
+template<typename T, size_t Capacity>
+struct SeqLockRing
+{
+    static_assert( std::is_trivially_copyable_v<T>, "values are copied bytewise" );
+    static_assert( Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2" );
+    
+    // writer thread only
+    void push(const T& value) noexcept
+    {
+        auto index = writeCount.load(std::memory_order_relaxed);
+        auto& slot = slots[index & mask];
+        
+        slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.store(value);
+        slot.sequence.store(2 * index + 2, std::memory_order_release);
+        
+        writeCount.store(index + 1, std::memory_order_release);
+    }
+    
+    // the total number of values written so far
+    juce::uint64 getWriteCount() const noexcept { return writeCount.load(std::memory_order_acquire); }
+    
+    bool readLatest(T& value) const noexcept
+    {
+        for ( ;; )
+        {
+            auto count = getWriteCount();
+            if ( count == 0 )
+                return false;
+            
+            // only fails if the writer has already moved on, in which case there's a newer value to read
+            if ( read(count - 1, value) )
+                return true;
+        }
+    }
+    
+    /*
+    position is the write count the reader has caught up to, it's advanced past everything read (or lost).
+    Returns how many values were handed to the callback.
+    */
+    template<typename Callback>
+    size_t readSince(juce::uint64& position, Callback&& callback) const
+    {
+        auto count = getWriteCount();
+        
+        if ( position > count )
+            position = count;
+        
+        if ( count - position > Capacity )
+            position = count - Capacity;
+        
+        size_t numRead = 0;
+        T value;
+        for ( ; position < count; ++position )
+        {
+            if ( read(position, value) )
+            {
+                callback(static_cast<const T&>(value));
+                ++numRead;
+            }
+        }
+        
+        return numRead;
+    }
+
+private:
+    static constexpr juce::uint64 mask = Capacity - 1;
+    
+    struct Slot
+    {
+        static constexpr size_t numWords = (sizeof(T) + sizeof(juce::uint32) - 1) / sizeof(juce::uint32);
+        
+        void store(const T& value) noexcept
+        {
+            std::array<juce::uint32, numWords> raw { };
+            std::memcpy(raw.data(), &value, sizeof(T));
+            
+            for ( size_t i = 0; i < numWords; ++i )
+            {
+                words[i].store(raw[i], std::memory_order_relaxed);
+            }
+        }
+        
+        void load(T& value) const noexcept
+        {
+            std::array<juce::uint32, numWords> raw;
+            
+            for ( size_t i = 0; i < numWords; ++i )
+            {
+                raw[i] = words[i].load(std::memory_order_relaxed);
+            }
+            
+            std::memcpy(&value, raw.data(), sizeof(T));
+        }
+        
+        std::atomic<juce::uint64> sequence { 0 };
+        std::array<std::atomic<juce::uint32>, numWords> words { };
+    };
+    
+    bool read(juce::uint64 index, T& value) const noexcept
+    {
+        const auto& slot = slots[index & mask];
+        const auto expected = 2 * index + 2;
+        
+        if ( slot.sequence.load(std::memory_order_acquire) != expected )
+            return false;
+        
+        slot.load(value);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        
+        return slot.sequence.load(std::memory_order_relaxed) == expected;
+    }
+    
+    std::array<Slot, Capacity> slots;
+    std::atomic<juce::uint64> writeCount { 0 };
+};
@@ -0,0 +1,184 @@
+/*
+  ==============================================================================
+  
+    SpectrumAverager.h
+    Created: 19 Oct 2026 2:08:53am
+    Author:  Matt Aiken
+  
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../Globals.h"
+#include "AnalyzerProperties.h"
+#include "FastMath.h"
+
+//==============================================================================
+/*
+Holds what the analyzer shows for each bin and folds every new frame into it, in decibels.
+
+    MaxEnvelope     follows peaks straight away and falls back at decayRate dB/s
+    MinEnvelope     the mirror image: follows dips straight away and rises at decayRate dB/s
+    Average         exponential average with a time constant of averagingTime
+    PeakHold        the highest value since the last reset
+    TimedHold       holds each bin's peak for averagingTime, then drops to the live value
+
+All of them go by the time that actually passed since the last frame, which the caller passes in, so a slower hop or
+a skipped frame doesn't change how fast anything moves. Everything that depends on the settings is worked out once per
+frame, and each mode is one pass over the bins, four at a time on SSE2 / NEON.
+*/
+struct SpectrumAverager
+{
+    using SIMDOps = FastMath::SIMDOps;
+    using ScalarOps = FastMath::ScalarOps;
+    
+    struct Settings
+    {
+        AnalyzerProperties::AveragingModes mode { AnalyzerProperties::MaxEnvelope };
+        float decayRate { 0.f };     // dB per second, for the envelopes
+        float averagingTime { 0.f }; // seconds, the time constant or the hold time
+        float negativeInfinity { Globals::getNegativeInf() };
+        float maxDecibels { Globals::getMaxDecibels() };
+    };
+    
+    // allocates
+    void prepare(int numValues, float initialValue)
+    {
+        values.assign(static_cast<size_t>(numValues), initialValue);
+        holdTimes.assign(static_cast<size_t>(numValues), 0.f);
+    }
+    
+    void reset(float initialValue)
+    {
+        std::fill(values.begin(), values.end(), initialValue);
+        std::fill(holdTimes.begin(), holdTimes.end(), 0.f);
+    }
+    
+    // input needs getValues().size() decibel values
+    void process(const float* input, const Settings& settings, float elapsedSeconds) noexcept
+    {
+        using namespace AnalyzerProperties;
+        
+        const auto floor = settings.negativeInfinity;
+        const auto ceiling = settings.maxDecibels;
+        
+        switch ( settings.mode )
+        {
+            case MaxEnvelope:
+            {
+                auto fall = settings.decayRate * elapsedSeconds;
+                forEachValue(input, [=](auto ops, auto value, auto in)
+                {
+                    using Ops = decltype(ops);
+                    return Ops::max(in, Ops::sub(value, Ops::set(fall)));
+                }, floor, ceiling);
+                break;
+            }
+            case MinEnvelope:
+            {
+                auto rise = settings.decayRate * elapsedSeconds;
+                forEachValue(input, [=](auto ops, auto value, auto in)
+                {
+                    using Ops = decltype(ops);
+                    return Ops::min(in, Ops::add(value, Ops::set(rise)));
+                }, floor, ceiling);
+                break;
+            }
+            case Average:
+            {
+                // the fraction of the way to the input an RC filter gets in elapsedSeconds
+                auto coefficient = settings.averagingTime > 0.f ? 1.f - std::exp(-elapsedSeconds / settings.averagingTime) : 1.f;
+                forEachValue(input, [=](auto ops, auto value, auto in)
+                {
+                    using Ops = decltype(ops);
+                    return Ops::mulAdd(Ops::sub(in, value), Ops::set(coefficient), value);
+                }, floor, ceiling);
+                break;
+            }
+            case PeakHold:
+            {
+                forEachValue(input, [](auto ops, auto value, auto in)
+                {
+                    using Ops = decltype(ops);
+                    return Ops::max(in, value);
+                }, floor, ceiling);
+                break;
+            }
+            case TimedHold:
+            {
+                processTimedHold(input, settings.averagingTime, elapsedSeconds, floor, ceiling);
+                break;
+            }
+        }
+    }
+    
+    const std::vector<float>& getValues() const { return values; }
+private:
+    std::vector<float> values;
+    std::vector<float> holdTimes; // seconds each bin's peak has left, only used by TimedHold
+    
+    template<typename Kernel>
+    void forEachValue(const float* input, Kernel kernel, float floor, float ceiling) noexcept
+    {
+        auto clamp = [floor, ceiling](auto ops, auto x)
+        {
+            using Ops = decltype(ops);
+            return Ops::max(Ops::min(x, Ops::set(ceiling)), Ops::set(floor));
+        };
+        
+        auto* data = values.data();
+        auto numValues = static_cast<int>(values.size());
+        
+        auto i = 0;
+        for ( ; i + SIMDOps::width <= numValues; i += SIMDOps::width )
+        {
+            auto result = kernel(SIMDOps(), SIMDOps::load(data + i), SIMDOps::load(input + i));
+            SIMDOps::store(data + i, clamp(SIMDOps(), result));
+        }
+        
+        for ( ; i < numValues; ++i )
+        {
+            data[i] = clamp(ScalarOps(), kernel(ScalarOps(), data[i], input[i]));
+        }
+    }
+    
+    void processTimedHold(const float* input, float holdTime, float elapsedSeconds, float floor, float ceiling) noexcept
+    {
+        /*
+        A bin the input reaches (or beats) starts its hold over. One the input stays under counts down, and once
+        its time is up it takes the input and starts over from there.
+        */
+        auto kernel = [=](auto ops, auto value, auto in, auto remaining, auto& newRemaining)
+        {
+            using Ops = decltype(ops);
+            auto zero = Ops::set(0.f);
+            auto fullHold = Ops::set(holdTime);
+            
+            remaining = Ops::pickIfGreater(value, in, Ops::sub(remaining, Ops::set(elapsedSeconds)), fullHold);
+            value = Ops::max(value, in);
+            
+            newRemaining = Ops::pickIfGreater(remaining, zero, remaining, fullHold);
+            value = Ops::pickIfGreater(remaining, zero, value, in);
+            return Ops::max(Ops::min(value, Ops::set(ceiling)), Ops::set(floor));
+        };
+        
+        auto* data = values.data();
+        auto* times = holdTimes.data();
+        auto numValues = static_cast<int>(values.size());
+        
+        auto i = 0;
+        for ( ; i + SIMDOps::width <= numValues; i += SIMDOps::width )
+        {
+            SIMDOps::Float remaining;
+            SIMDOps::store(data + i, kernel(SIMDOps(), SIMDOps::load(data + i), SIMDOps::load(input + i), SIMDOps::load(times + i), remaining));
+            SIMDOps::store(times + i, remaining);
+        }
+        
+        for ( ; i < numValues; ++i )
+        {
+            data[i] = kernel(ScalarOps(), data[i], input[i], times[i], times[i]);
+        }
+    }
+};
@@ -0,0 +1,105 @@
+/*
+  ==============================================================================
+  
+    SpectrumSmoother.h
+    Created: 19 Oct 2026 3:17:06am
+    Author:  Matt Aiken
+  
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FastMath.h"
+
+//==============================================================================
+/*
+Fractional-octave smoothing: every bin becomes the mean power of the bins within 1/N octave around it
+(half of that either side, so 1/3 octave runs from a sixth of an octave below to a sixth above).
+
+Which bins each window covers is worked out when the bins or N change. Each frame then converts to power,
+takes one running sum and reads every window's total off it as a difference of two entries, so the cost is
+O(numBins) however wide the windows are. The sum is kept in doubles: the windows at the top end subtract
+totals that can be 100 dB bigger than what's between them.
+
+The bins don't have to be evenly spaced, so the same smoother works for the multi-resolution frames.
+*/
+struct SpectrumSmoother
+{
+    // allocates. the centre frequencies of the bins, in ascending order
+    void setBinFrequencies(const std::vector<float>& newBinFrequencies)
+    {
+        binFrequencies = newBinFrequencies;
+        
+        auto numBins = binFrequencies.size();
+        firstBins.resize(numBins);
+        endBins.resize(numBins);
+        powers.resize(numBins);
+        runningSum.resize(numBins + 1);
+        
+        updateWindows();
+    }
+    
+    // the N in 1/N octave, 0 turns smoothing off
+    void setOctaveFraction(int newOctaveFraction)
+    {
+        octaveFraction = newOctaveFraction;
+        updateWindows();
+    }
+    
+    int getOctaveFraction() const { return octaveFraction; }
+    bool isActive() const { return octaveFraction > 0 && !binFrequencies.empty(); }
+    
+    // decibels in and out, one value per bin. input and output can be the same
+    void process(const float* input, float* output, float minusInfinityDb) noexcept
+    {
+        auto numBins = static_cast<int>(binFrequencies.size());
+        
+        // 10^(dB / 10) is the gain of twice the decibels
+        juce::FloatVectorOperations::multiply(powers.data(), input, 2.f, numBins);
+        FastMath::decibelsToGains<FastMath::Accuracy::Low>(powers.data(), powers.data(), numBins, minusInfinityDb * 2.f);
+        
+        runningSum[0] = 0.0;
+        for ( auto i = 0; i < numBins; ++i )
+        {
+            runningSum[static_cast<size_t>(i + 1)] = runningSum[static_cast<size_t>(i)] + static_cast<double>(powers[static_cast<size_t>(i)]);
+        }
+        
+        for ( auto i = 0; i < numBins; ++i )
+        {
+            auto first = firstBins[static_cast<size_t>(i)];
+            auto end = endBins[static_cast<size_t>(i)];
+            auto total = runningSum[static_cast<size_t>(end)] - runningSum[static_cast<size_t>(first)];
+            powers[static_cast<size_t>(i)] = static_cast<float>(total / static_cast<double>(end - first));
+        }
+        
+        FastMath::scaledPowersToDecibels<FastMath::Accuracy::Low>(powers.data(), output, numBins, 1.f, minusInfinityDb);
+    }
+private:
+    std::vector<float> binFrequencies;
+    int octaveFraction { 0 };
+    
+    std::vector<int> firstBins, endBins; // each bin's window, [first, end)
+    std::vector<float> powers;
+    std::vector<double> runningSum;      // runningSum[i] is the total power of the bins below i
+    
+    void updateWindows()
+    {
+        if ( !isActive() )
+            return;
+        
+        auto halfWidth = std::pow(2.f, 0.5f / static_cast<float>(octaveFraction));
+        
+        for ( size_t i = 0; i < binFrequencies.size(); ++i )
+        {
+            auto centre = binFrequencies[i];
+            auto first = std::lower_bound(binFrequencies.begin(), binFrequencies.end(), centre / halfWidth);
+            auto end = std::upper_bound(binFrequencies.begin(), binFrequencies.end(), centre * halfWidth);
+            
+            // always at least the bin itself, which DC and the bins at the bottom often are
+            firstBins[i] = juce::jmin(static_cast<int>(std::distance(binFrequencies.begin(), first)), static_cast<int>(i));
+            endBins[i] = juce::jmax(static_cast<int>(std::distance(binFrequencies.begin(), end)), static_cast<int>(i) + 1);
+        }
+    }
+};
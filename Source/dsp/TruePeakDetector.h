@@ -0,0 +1,133 @@
+/*
+  ==============================================================================
+  
+    TruePeakDetector.h
+    Created: 18 Oct 2026 11:02:37pm
+    Author:  Matt Aiken
+  
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+#include "FastMath.h"
+
+//==============================================================================
+/*
+4x oversampled true-peak detection (ITU-R BS.1770 annex 2) for one channel.
+
+The interpolator is a 48 tap windowed-sinc lowpass split into four 12 tap phases. Each phase gives one of the four
+upsampled values between two input samples, so all it takes per input sample is 12 loads and 48 multiply-adds,
+done four input samples at a time with SIMD. Only the largest magnitude is kept: the upsampled signal is never stored.
+
+The caller writes the block's samples to getInputPointer() and then calls processBlock(), which also carries the
+last 11 samples over as the filter history for the next block. Everything is allocated in prepare().
+*/
+struct TruePeakDetector
+{
+    static constexpr int oversamplingFactor = 4;
+    static constexpr int tapsPerPhase = 12;
+    
+    TruePeakDetector()
+    {
+        constexpr auto numTaps = oversamplingFactor * tapsPerPhase;
+        constexpr auto centre = (numTaps - 1) / 2.0;
+        
+        for ( auto phase = 0; phase < oversamplingFactor; ++phase )
+        {
+            double phaseSum = 0.0;
+            
+            for ( auto k = 0; k < tapsPerPhase; ++k )
+            {
+                auto n = phase + oversamplingFactor * k;
+                auto t = (n - centre) / oversamplingFactor; // in input samples
+                auto sinc = std::sin(juce::MathConstants<double>::pi * t) / (juce::MathConstants<double>::pi * t);
+                auto x = juce::MathConstants<double>::twoPi * (n + 0.5) / numTaps;
+                auto blackmanHarris = 0.35875 - 0.48829 * std::cos(x) + 0.14128 * std::cos(2.0 * x) - 0.01168 * std::cos(3.0 * x);
+                
+                coefficients[phase][k] = static_cast<float>(sinc * blackmanHarris);
+                phaseSum += sinc * blackmanHarris;
+            }
+            
+            // every phase passes DC at unity, otherwise a constant signal would ripple at the upsampled rate
+            for ( auto& c : coefficients[phase] )
+                c = static_cast<float>(c / phaseSum);
+        }
+    }
+    
+    void prepare(int maximumBlockSize)
+    {
+        history.assign(static_cast<size_t>(historyLength + maximumBlockSize), 0.f);
+        capacity = maximumBlockSize;
+    }
+    
+    void reset() { std::fill(history.begin(), history.end(), 0.f); }
+    
+    int getCapacity() const noexcept { return capacity; }
+    
+    // this block's first sample goes here, right after the history
+    float* getInputPointer() noexcept { return history.data() + historyLength; }
+    
+    // returns the block's true peak as a gain (never less than its sample peak)
+    float processBlock(int numSamples) noexcept
+    {
+        jassert( numSamples <= capacity );
+        
+        // nothing to scan, and the history is already where the next block expects it
+        if ( numSamples <= 0 )
+            return 0.f;
+        
+        using SIMD = FastMath::SIMDOps;
+        auto vectorPeak = SIMD::set(0.f);
+        auto n = 0;
+        
+        for ( ; n + SIMD::width <= numSamples; n += SIMD::width )
+            vectorPeak = SIMD::max(vectorPeak, interpolatedPeak<SIMD>(n));
+        
+        auto peak = 0.f;
+        for ( ; n < numSamples; ++n )
+            peak = juce::jmax(peak, interpolatedPeak<FastMath::ScalarOps>(n));
+        
+        std::array<float, SIMD::width> lanes;
+        SIMD::store(lanes.data(), vectorPeak);
+        for ( auto lane : lanes )
+            peak = juce::jmax(peak, lane);
+        
+        // the end of this block is the start of the next one's filter history
+        std::copy(history.begin() + numSamples, history.begin() + numSamples + historyLength, history.begin());
+        
+        return peak;
+    }
+
+private:
+    static constexpr int historyLength = tapsPerPhase - 1;
+    
+    // the largest magnitude of the four upsampled values around input sample n (Ops::width samples at once)
+    template<typename Ops>
+    typename Ops::Float interpolatedPeak(int n) const noexcept
+    {
+        std::array<typename Ops::Float, oversamplingFactor> sums;
+        sums.fill(Ops::set(0.f));
+        
+        // x[n - k] for this block's sample n lives at history[historyLength + n - k]
+        const auto* newest = history.data() + historyLength + n;
+        for ( auto k = 0; k < tapsPerPhase; ++k )
+        {
+            auto x = Ops::load(newest - k);
+            for ( auto phase = 0; phase < oversamplingFactor; ++phase )
+                sums[phase] = Ops::mulAdd(Ops::set(coefficients[phase][k]), x, sums[phase]);
+        }
+        
+        auto peak = Ops::abs(Ops::load(newest));
+        for ( auto& sum : sums )
+            peak = Ops::max(peak, Ops::abs(sum));
+        
+        return peak;
+    }
+    
+    std::array<std::array<float, tapsPerPhase>, oversamplingFactor> coefficients;
+    std::vector<float> history;
+    int capacity { 0 };
+};
@@ -10,8 +10,14 @@
 
 #pragma once
 
+#include "../Globals.h"
+
 //==============================================================================
+// everything a band's meters show for one block, published by the audio thread in one go
 struct BandLevel
 {
-    float rmsInputLevelDb, rmsOutputLevelDb;
+    float peakInputLevelDb { Globals::getNegativeInf() }, rmsInputLevelDb { Globals::getNegativeInf() };
+    float peakOutputLevelDb { Globals::getNegativeInf() }, rmsOutputLevelDb { Globals::getNegativeInf() };
+    // from the compressor's gain computer, 0 or below: the lowest gain of the block and the average one
+    float maxGainReductionDb { 0.f }, meanGainReductionDb { 0.f };
 };
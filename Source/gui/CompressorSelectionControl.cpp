@@ -220,5 +220,5 @@ void CompressorSelectionControl::updateEnablements(juce::Button* clickedButton)
 
 void CompressorSelectionControl::updateMeter(const BandLevel& level)
 {
-    meter.update(level.rmsInputLevelDb, level.rmsOutputLevelDb);
+    meter.update(level.rmsInputLevelDb, level.rmsOutputLevelDb, level.meanGainReductionDb, level.maxGainReductionDb);
 }
@@ -91,10 +91,10 @@ void Meter::paint(juce::Graphics& g)
     g.drawRect(maxMeterBounds);
 }
 
-void Meter::update(const float& peakDbLevel, const float& rmsDbLevel)
+void Meter::update(const float& peakDbLevel, const float& rmsDbLevel, const float& truePeakDbLevel)
 {
     peakDb = peakDbLevel;
-    fallingTick.updateHeldValue(peakDbLevel);
+    fallingTick.updateHeldValue(truePeakDbLevel); // the tick and the over light catch inter-sample overs
     averageMeter.add(rmsDbLevel);
     repaint();
 }
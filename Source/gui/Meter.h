@@ -20,7 +20,7 @@ struct Meter : juce::Component
 {
     Meter(const juce::String& label, const float& meterHeightProportion);
     void paint(juce::Graphics& g) override;
-    void update(const float& peakDbLevel, const float& rmsDbLevel);
+    void update(const float& peakDbLevel, const float& rmsDbLevel, const float& truePeakDbLevel);
     float getMeterProportion() { return meterProportion; }
 private:
     float peakDb { Globals::getNegativeInf() };
@@ -9,13 +9,21 @@
 */
 
 #include "PathProducer.h"
+#include "../ColourPalette.h"
 
 //==============================================================================
-PathProducer::PathProducer(double _sampleRate, SingleChannelSampleFifo<juce::AudioBuffer<float>>& scsf)
+PathProducer::PathProducer(double _sampleRate, AnalysisRing& ring)
 : juce::Thread("PathProducerThread"),
-  singleChannelSampleFifo(&scsf),
+  analysisRing(&ring),
   sampleRate(_sampleRate)
 {
+    // before prepareToPlay there's no rate, updateSampleRate() prepares it once the ring has one
+    if ( sampleRate > 0.0 )
+        multiResolution.prepare(sampleRate, multiResolutionChunk.getNumSamples());
+    
+    traceColours[Channel::Left] = ColourPalette::getColour(ColourPalette::Blue);
+    traceColours[Channel::Right] = ColourPalette::getColour(ColourPalette::MeterGreen);
+    
     startThread();
 }
 
@@ -29,54 +37,104 @@ void PathProducer::run()
 {
     while (!threadShouldExit())
     {
-        if ( !processingIsEnabled.load() )
+        if ( !processingIsEnabled.load() || !updateSampleRate() )
         {
             wait(10);
             continue;
         }
         
-        while ( singleChannelSampleFifo->getNumCompleteBuffersAvailable() > 0 )
+        if ( averagingResetRequested.exchange(false) )
+        {
+            for ( auto& averager : averagers )
+            {
+                averager.reset(negativeInfinity.load());
+            }
+        }
+        
+        /*
+        A frame is analyzed every hop, read straight out of the ring (wrapping around its end) rather than shifted
+        along a buffer, so the work depends on the hop and not on the host's block size.
+        Frames stay on the hop grid. If this thread fell behind it skips to the newest frame instead of catching up,
+        and the audio side never waits for it either way.
+        Left and right go through one complex FFT together.
+        In multi-resolution mode the same hop drives the analyzer's top level, which is fed everything since the last frame.
+        */
+        auto hopSize = getHopSize();
+        auto latest = analysisRing->getWritePosition();
+        
+        // prepareToPlay starts the ring's count over
+        lastAnalyzedPosition = juce::jmin(lastAnalyzedPosition, latest);
+        lastPushedPosition = juce::jmin(lastPushedPosition, latest);
+        lastFramePosition = juce::jmin(lastFramePosition, latest);
+        
+        auto pending = latest - lastAnalyzedPosition;
+        if ( pending >= hopSize )
         {
-            juce::AudioBuffer<float> tempBuffer;
+            lastAnalyzedPosition += (pending / hopSize) * hopSize;
             
-            if ( threadShouldExit() )
-                break;
+            // skipped frames included, so the display moves at the same speed whatever happened in between
+            frameElapsedSeconds = static_cast<float>(static_cast<double>(lastAnalyzedPosition - lastFramePosition) / sampleRate);
+            lastFramePosition = lastAnalyzedPosition;
             
-            if ( singleChannelSampleFifo->getAudioBuffer(tempBuffer) )
+            if ( multiResolutionIsEnabled.load() )
             {
-                auto size = juce::jmin(tempBuffer.getNumSamples(), bufferForGenerator.getNumSamples());
-                auto readPtr = bufferForGenerator.getReadPointer(0, size);
-                auto writePtr = bufferForGenerator.getWritePointer(0, 0);
-                std::copy(readPtr, readPtr + (bufferForGenerator.getNumSamples() - size), writePtr);
-                
-                juce::FloatVectorOperations::copy(bufferForGenerator.getWritePointer(0, bufferForGenerator.getNumSamples() - size),
-                                                  tempBuffer.getReadPointer(0, 0),
-                                                  size);
+                if ( analyzeMultiResolution() )
+                {
+                    const auto& frame = multiResolution.getFrame();
+                    auto numBins = multiResolution.getNumBins();
+                    auto settings = getAveragingSettings();
+                    
+                    for ( auto channel : { Channel::Left, Channel::Right } )
+                    {
+                        averagers[channel].process(smooth(frame.data() + channel * numBins), settings, frameElapsedSeconds);
+                        pathGenerators[channel].generatePath(averagers[channel].getValues(), fftBounds, multiResolution.getBinFrequencies());
+                    }
+                    
+                    renderImage();
+                }
+            }
+            else
+            {
+                auto readChannel = [this](Channel channel)
+                {
+                    return analysisRing->read(channel, lastAnalyzedPosition, bufferForGenerator.getWritePointer(channel), bufferForGenerator.getNumSamples());
+                };
                 
-                fftDataGenerator.produceFFTDataForRendering(bufferForGenerator);
+                if ( readChannel(Channel::Left) && readChannel(Channel::Right) )
+                    fftDataGenerator.produceStereoFFTDataForRendering(bufferForGenerator);
             }
         }
         
-        while ( fftDataGenerator.getNumAvailableFFTDataBlocks() > 0 )
+        // frames are read where the generator wrote them and handed straight back
+        auto numFramesGenerated = 0;
+        for ( auto index = fftDataGenerator.pullFFTFrame(); index >= 0; index = fftDataGenerator.pullFFTFrame() )
         {
-            std::vector<float> fftData;
-            
-            if ( threadShouldExit() )
-                break;
-            
-            if ( fftDataGenerator.getFFTData(fftData) )
+            if ( !threadShouldExit() )
             {
+                const auto& fftData = fftDataGenerator.getFFTFrame(index);
                 auto fftSize = getFFTSize();
-                auto numBins = static_cast<int>(fftSize * 0.5);
-                auto decayRate = decayRateInDbPerSec.load() / 60.f;
+                auto numBins = fftDataGenerator.getNumBins();
+                auto settings = getAveragingSettings();
                 
-                updateRenderData(renderData, fftData, numBins, decayRate);
+                for ( auto channel : { Channel::Left, Channel::Right } )
+                {
+                    averagers[channel].process(smooth(fftData.data() + channel * (numBins + 1)), settings, frameElapsedSeconds);
+                    pathGenerators[channel].generatePath(averagers[channel].getValues(), fftBounds, fftSize, static_cast<float>(getBinWidth()));
+                }
                 
-                pathGenerator.generatePath(renderData, fftBounds, fftSize, static_cast<float>(getBinWidth()));
+                ++numFramesGenerated;
             }
+            
+            fftDataGenerator.releaseFFTFrame(index);
         }
         
-        wait(10);
+        // only the latest of them gets shown
+        if ( numFramesGenerated > 0 )
+            renderImage();
+        
+        // sleep until the next frame is due
+        auto samplesToNextFrame = hopSize - (analysisRing->getWritePosition() - lastAnalyzedPosition);
+        wait(juce::jlimit(1, 10, static_cast<int>(1000.0 * static_cast<double>(samplesToNextFrame) / sampleRate)));
     }
 }
 
@@ -86,12 +144,10 @@ void PathProducer::changeOrder(FFTOrder order)
     
     fftDataGenerator.changeOrder(order);
     
-    auto fftSize = getFFTSize();
-    renderData.clear();
-    renderData.resize(static_cast<size_t>(fftSize * 2), negativeInfinity.load());
-    bufferForGenerator.setSize(1, fftSize);
+    prepareFrameLayout();
+    bufferForGenerator.setSize(2, getFFTSize());
     
-    while ( !singleChannelSampleFifo->isPrepared() )
+    while ( !analysisRing->isPrepared() )
     {
         wait(5);
     }
@@ -102,6 +158,139 @@ void PathProducer::changeOrder(FFTOrder order)
     }
 }
 
+bool PathProducer::updateSampleRate()
+{
+    // the editor can be opened before prepareToPlay, when the processor doesn't have a rate yet
+    if ( !analysisRing->isPrepared() )
+        return false;
+    
+    auto ringSampleRate = analysisRing->getSampleRate();
+    if ( ringSampleRate <= 0.0 )
+        return false;
+    
+    if ( ringSampleRate != sampleRate )
+    {
+        sampleRate = ringSampleRate;
+        
+        // the levels and their bins depend on the rate
+        multiResolution.prepare(sampleRate, multiResolutionChunk.getNumSamples());
+        lastPushedPosition = 0;
+        
+        prepareFrameLayout();
+    }
+    
+    return true;
+}
+
+void PathProducer::setMultiResolution(bool shouldUseMultiResolution)
+{
+    if ( shouldUseMultiResolution == multiResolutionIsEnabled.load() )
+        return;
+    
+    pauseThread();
+    
+    multiResolutionIsEnabled.store(shouldUseMultiResolution);
+    multiResolution.reset();
+    lastPushedPosition = 0;
+    prepareFrameLayout();
+    
+    if ( !fftBounds.isEmpty() )
+    {
+        startThread();
+    }
+}
+
+bool PathProducer::analyzeMultiResolution()
+{
+    /*
+    Everything since the last frame goes through the decimators in order. If there's a gap (the thread was paused,
+    or fell behind) only the last getHistoryLength() samples matter, so it starts over from there.
+    */
+    auto start = juce::jmax(lastPushedPosition, lastAnalyzedPosition - multiResolution.getHistoryLength());
+    if ( start != lastPushedPosition )
+        multiResolution.reset();
+    
+    lastPushedPosition = lastAnalyzedPosition;
+    
+    for ( auto position = start; position < lastAnalyzedPosition; )
+    {
+        auto numSamples = static_cast<int>(juce::jmin<juce::int64>(multiResolutionChunk.getNumSamples(), lastAnalyzedPosition - position));
+        position += numSamples;
+        
+        auto readChannel = [&](Channel channel)
+        {
+            return analysisRing->read(channel, position, multiResolutionChunk.getWritePointer(channel), numSamples);
+        };
+        
+        // overwritten while it was read, next frame starts over
+        if ( !readChannel(Channel::Left) || !readChannel(Channel::Right) )
+        {
+            multiResolution.reset();
+            lastPushedPosition = 0;
+            return false;
+        }
+        
+        multiResolution.push(multiResolutionChunk.getReadPointer(Channel::Left),
+                             multiResolutionChunk.getReadPointer(Channel::Right),
+                             numSamples);
+    }
+    
+    multiResolution.analyze();
+    return true;
+}
+
+void PathProducer::prepareFrameLayout()
+{
+    std::vector<float> binFrequencies;
+    
+    if ( multiResolutionIsEnabled.load() )
+    {
+        binFrequencies = multiResolution.getBinFrequencies();
+    }
+    else
+    {
+        binFrequencies.resize(static_cast<size_t>(fftDataGenerator.getNumBins() + 1));
+        auto binWidth = static_cast<float>(getBinWidth());
+        for ( size_t i = 0; i < binFrequencies.size(); ++i )
+        {
+            binFrequencies[i] = static_cast<float>(i) * binWidth;
+        }
+    }
+    
+    auto size = static_cast<int>(binFrequencies.size());
+    for ( auto& averager : averagers )
+    {
+        averager.prepare(size, negativeInfinity.load());
+    }
+    
+    smoother.setBinFrequencies(binFrequencies);
+    smoothedFrame.resize(binFrequencies.size());
+}
+
+const float* PathProducer::smooth(const float* frame)
+{
+    auto octaveFraction = smoothingOctaveFraction.load();
+    if ( octaveFraction != smoother.getOctaveFraction() )
+        smoother.setOctaveFraction(octaveFraction);
+    
+    if ( !smoother.isActive() )
+        return frame;
+    
+    smoother.process(frame, smoothedFrame.data(), negativeInfinity.load());
+    return smoothedFrame.data();
+}
+
+SpectrumAverager::Settings PathProducer::getAveragingSettings() const
+{
+    SpectrumAverager::Settings settings;
+    settings.mode = averagingMode.load();
+    settings.decayRate = decayRateInDbPerSec.load();
+    settings.averagingTime = averagingTimeInSeconds.load();
+    settings.negativeInfinity = negativeInfinity.load();
+    settings.maxDecibels = maxDecibels.load();
+    return settings;
+}
+
 int PathProducer::getFFTSize() const
 {
     return fftDataGenerator.getFFTSize();
@@ -117,54 +306,135 @@ void PathProducer::pauseThread()
     stopThread(100);
 }
 
-void PathProducer::setFFTRectBounds(juce::Rectangle<float> bounds)
+void PathProducer::setFFTRectBounds(juce::Rectangle<float> bounds, float scale)
 {
     pauseThread();
     
     if ( !bounds.isEmpty() )
     {
-        fftBounds = bounds;
+        auto width = juce::roundToInt(bounds.getWidth() * scale);
+        auto height = juce::roundToInt(bounds.getHeight() * scale);
+        
+        fftBounds = { 0.f, 0.f, static_cast<float>(width), static_cast<float>(height) };
+        imageScale = scale;
+        
+        imageQueue.clear(imagePool);
+        imagePool.prepare([width, height](juce::Image& image)
+        {
+            image = juce::Image(juce::Image::ARGB, width, height, true);
+        });
     }
     
     startThread();
 }
 
+void PathProducer::renderImage()
+{
+    // the editor is holding on to every image, this frame would only be dropped
+    auto index = imagePool.acquire();
+    if ( index < 0 )
+        return;
+    
+    auto& image = imagePool.get(index);
+    if ( !image.isValid() ) // no bounds yet
+    {
+        imagePool.release(index);
+        return;
+    }
+    
+    {
+        juce::Image::BitmapData bitmap(image, juce::Image::BitmapData::writeOnly);
+        SpectrumRasterizer::clear(bitmap);
+        
+        auto fill = fillIsEnabled.load();
+        for ( auto channel : { Channel::Left, Channel::Right } )
+        {
+            auto colour = traceColours[channel];
+            SpectrumRasterizer::drawTrace(bitmap,
+                                          pathGenerators[channel].getColumnPositions(),
+                                          colour,
+                                          fill ? colour.withMultipliedAlpha(0.2f) : juce::Colours::transparentBlack,
+                                          imageScale);
+        }
+    }
+    
+    if ( !imageQueue.push(index) )
+        imagePool.release(index);
+}
+
 void PathProducer::setDecayRate(float decayRate)
 {
     decayRateInDbPerSec.store(decayRate);
 }
 
-bool PathProducer::pull(juce::Path& path)
+void PathProducer::setAveraging(AnalyzerProperties::AveragingModes mode)
 {
-    return pathGenerator.getPath(path);
+    averagingMode.store(mode);
 }
 
-int PathProducer::getNumAvailableForReading() const
+void PathProducer::setAveragingTime(float milliseconds)
 {
-    return pathGenerator.getNumPathsAvailable();
+    averagingTimeInSeconds.store(milliseconds / 1000.f);
 }
 
-void PathProducer::toggleProcessing(bool toggleState)
+void PathProducer::setSmoothing(AnalyzerProperties::SmoothingModes mode)
 {
-    processingIsEnabled.store(toggleState);
+    smoothingOctaveFraction.store(AnalyzerProperties::getOctaveFraction(mode));
 }
 
-void PathProducer::changePathRange(float negativeInfinityDb, float maxDb)
+void PathProducer::setOverlap(AnalyzerProperties::OverlapModes mode)
 {
-    negativeInfinity.store(negativeInfinityDb);
-    maxDecibels.store(maxDb);
+    overlapMode.store(mode);
 }
 
-void PathProducer::updateRenderData(std::vector<float>& renData, const std::vector<float>& fftData, int numBins, float decayRate)
+int PathProducer::getHopSize() const
 {
-    if ( decayRate >= 0.f )
+    // in multi-resolution mode the top level is the one that needs the overlap
+    auto fftSize = multiResolutionIsEnabled.load() ? 1 << MultiResolutionAnalyzer::levelOrder : getFFTSize();
+    auto displayRateHop = juce::jmax(1, static_cast<int>(std::ceil(sampleRate / maxFramesPerSecond)));
+    
+    switch ( overlapMode.load() )
     {
-        for ( auto i = 0; i < numBins; ++i )
-        {
-            auto previousValue = renData[i];
-            auto candidate = fftData[i];
-            auto finalValue = juce::jmax(candidate, previousValue - decayRate);
-            renData[i] = juce::jlimit(negativeInfinity.load(), maxDecibels.load(), finalValue);
-        }
+        case AnalyzerProperties::Overlap50:   return juce::jmax(fftSize / 2, displayRateHop);
+        case AnalyzerProperties::Overlap75:   return juce::jmax(fftSize / 4, displayRateHop);
+        case AnalyzerProperties::DisplayRate: break;
     }
+    
+    return displayRateHop;
+}
+
+void PathProducer::setFillArea(bool shouldFillArea)
+{
+    fillIsEnabled.store(shouldFillArea);
+}
+
+void PathProducer::resetAveraging()
+{
+    averagingResetRequested.store(true);
+}
+
+int PathProducer::pullLatestImage()
+{
+    return imageQueue.pullLatest(imagePool);
+}
+
+const juce::Image& PathProducer::getImage(int index) const
+{
+    return imagePool.get(index);
+}
+
+void PathProducer::releaseImage(int index)
+{
+    imagePool.release(index);
+}
+
+void PathProducer::toggleProcessing(bool toggleState)
+{
+    processingIsEnabled.store(toggleState);
+}
+
+void PathProducer::changePathRange(float negativeInfinityDb, float maxDb)
+{
+    negativeInfinity.store(negativeInfinityDb);
+    maxDecibels.store(maxDb);
 }
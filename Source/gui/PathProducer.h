@@ -12,14 +12,21 @@
 
 #include <JuceHeader.h>
 #include "../Globals.h"
-#include "../dsp/SingleChannelSampleFifo.h"
+#include "../Channel.h"
+#include "../dsp/AnalysisRing.h"
+#include "../dsp/AnalyzerProperties.h"
 #include "../dsp/FFTDataGenerator.h"
 #include "../dsp/AnalyzerPathGenerator.h"
+#include "../dsp/MultiResolutionAnalyzer.h"
+#include "../dsp/SpectrumAverager.h"
+#include "../dsp/SpectrumSmoother.h"
+#include "../dsp/FramePool.h"
+#include "SpectrumRasterizer.h"
 
 //==============================================================================
 struct PathProducer : juce::Thread
 {
-    PathProducer(double _sampleRate, SingleChannelSampleFifo<juce::AudioBuffer<float>>& scsf);
+    PathProducer(double _sampleRate, AnalysisRing& ring);
     ~PathProducer() override;
     
     void run() override;
@@ -27,33 +34,77 @@ struct PathProducer : juce::Thread
     int getFFTSize() const;
     double getBinWidth() const;
     void pauseThread();
-    void setFFTRectBounds(juce::Rectangle<float> bounds);
+    // the caller mustn't be holding an image from pullLatestImage(), they're all remade at the new size.
+    // scale is physical pixels per logical one, so the traces are drawn at the display's resolution
+    void setFFTRectBounds(juce::Rectangle<float> bounds, float scale);
     
     void setDecayRate(float decayRate);
-    bool pull(juce::Path& path);
-    int getNumAvailableForReading() const;
+    void setAveraging(AnalyzerProperties::AveragingModes mode);
+    void setAveragingTime(float milliseconds);
+    void setSmoothing(AnalyzerProperties::SmoothingModes mode);
+    void setOverlap(AnalyzerProperties::OverlapModes mode);
+    void setMultiResolution(bool shouldUseMultiResolution);
+    int getHopSize() const;
+    void setFillArea(bool shouldFillArea);
+    
+    // starts the averages and held peaks over. Safe from any thread, the analyzer thread does the reset
+    void resetAveraging();
+    
+    // the newest rendered frame, or -1 if there's nothing new. both channels' traces on a transparent background,
+    // the size of the fft bounds times the scale. it isn't touched until it's handed back with releaseImage()
+    int pullLatestImage();
+    const juce::Image& getImage(int index) const;
+    void releaseImage(int index);
     void toggleProcessing(bool toggleState);
     void changePathRange(float negativeInfinityDb, float maxDb);
 private:
-    SingleChannelSampleFifo<juce::AudioBuffer<float>>* singleChannelSampleFifo;
+    AnalysisRing* analysisRing;
+    juce::int64 lastAnalyzedPosition { 0 };
+    juce::int64 lastFramePosition { 0 }; // where the frame before lastAnalyzedPosition's ended
+    float frameElapsedSeconds { 0.f };
+    
+    // no point making frames faster than the analyzer repaints
+    static constexpr int maxFramesPerSecond = 60;
     FFTDataGenerator fftDataGenerator;
-    AnalyzerPathGenerator pathGenerator;
+    std::array<AnalyzerPathGenerator, 2> pathGenerators;
+    
+    // the traces are drawn here, on this thread, so painting them is only a blit
+    FramePool<juce::Image, 4> imagePool;
+    FrameQueue<3> imageQueue;
+    std::array<juce::Colour, 2> traceColours;
+    
+    void renderImage();
+    
+    std::array<SpectrumAverager, 2> averagers; // what's on screen, per channel
+    SpectrumSmoother smoother;
+    std::vector<float> smoothedFrame;
     
-    std::vector<float> renderData;
+    MultiResolutionAnalyzer multiResolution;
+    juce::int64 lastPushedPosition { 0 }; // how far into the ring multiResolution has been fed
+    juce::AudioBuffer<float> multiResolutionChunk { 2, 4096 };
     
-    void updateRenderData(std::vector<float>& renData,
-                          const std::vector<float>& fftData,
-                          int numBins,
-                          float decayRate);
+    bool analyzeMultiResolution();
+    bool updateSampleRate(); // takes the ring's rate, false while it doesn't have one
+    void prepareFrameLayout();
+    SpectrumAverager::Settings getAveragingSettings() const;
+    const float* smooth(const float* frame);
     
     juce::AudioBuffer<float> bufferForGenerator;
     
     double sampleRate;
-    juce::Rectangle<float> fftBounds;
+    juce::Rectangle<float> fftBounds; // in the images' pixels
+    float imageScale { 1.f };
     
     std::atomic<float> decayRateInDbPerSec { 0.f },
+                       averagingTimeInSeconds { 0.5f },
                        negativeInfinity { Globals::getNegativeInf() },
                        maxDecibels { Globals::getMaxDecibels() };
     
-    std::atomic<bool> processingIsEnabled { false };
+    std::atomic<bool> processingIsEnabled { false },
+                      multiResolutionIsEnabled { false },
+                      fillIsEnabled { false },
+                      averagingResetRequested { false };
+    std::atomic<AnalyzerProperties::OverlapModes> overlapMode { AnalyzerProperties::Overlap75 };
+    std::atomic<AnalyzerProperties::AveragingModes> averagingMode { AnalyzerProperties::MaxEnvelope };
+    std::atomic<int> smoothingOctaveFraction { 0 };
 };
@@ -14,12 +14,10 @@
 
 //==============================================================================
 SpectrumAnalyzer::SpectrumAnalyzer(double _sampleRate,
-                                   SingleChannelSampleFifo<juce::AudioBuffer<float>>& leftScsf,
-                                   SingleChannelSampleFifo<juce::AudioBuffer<float>>& rightScsf,
+                                   AnalysisRing& analysisRing,
                                    juce::AudioProcessorValueTreeState& apvts)
 : sampleRate(_sampleRate),
-  leftPathProducer(_sampleRate, leftScsf),
-  rightPathProducer(_sampleRate, rightScsf)
+  pathProducer(_sampleRate, analysisRing)
 {
     const auto& params = AnalyzerProperties::getAnalyzerParams();
     
@@ -42,6 +40,30 @@ SpectrumAnalyzer::SpectrumAnalyzer(double _sampleRate,
                  AnalyzerProperties::ParamNames::Analyzer_Points,
                  [this](const auto& newOrder){ updateOrder(newOrder); });
     
+    initListener(analyzerOverlapParamListener,
+                 AnalyzerProperties::ParamNames::Analyzer_Overlap,
+                 [this](const auto& newOverlap){ updateOverlap(newOverlap); });
+    
+    initListener(analyzerMultiResolutionParamListener,
+                 AnalyzerProperties::ParamNames::Analyzer_Multi_Resolution,
+                 [this](const auto& multiResolutionStatus){ updateMultiResolution(multiResolutionStatus); });
+    
+    initListener(analyzerAveragingParamListener,
+                 AnalyzerProperties::ParamNames::Analyzer_Averaging,
+                 [this](const auto& newAveraging){ updateAveraging(newAveraging); });
+    
+    initListener(analyzerAveragingTimeParamListener,
+                 AnalyzerProperties::ParamNames::Analyzer_Averaging_Time,
+                 [this](const auto& averagingTime){ updateAveragingTime(averagingTime); });
+    
+    initListener(analyzerSmoothingParamListener,
+                 AnalyzerProperties::ParamNames::Analyzer_Smoothing,
+                 [this](const auto& newSmoothing){ updateSmoothing(newSmoothing); });
+    
+    initListener(analyzerFillParamListener,
+                 AnalyzerProperties::ParamNames::Analyzer_Fill,
+                 [this](const auto& fillStatus){ updateFill(fillStatus); });
+    
     auto enabledParam = apvts.getParameter(params.at(AnalyzerProperties::ParamNames::Enable_Analyzer));
     setActive(enabledParam->getValue());
 
@@ -51,8 +73,25 @@ SpectrumAnalyzer::SpectrumAnalyzer(double _sampleRate,
     auto orderParam = apvts.getParameter(params.at(AnalyzerProperties::ParamNames::Analyzer_Points));
     updateOrder(orderParam->getValue());
     
-    leftPathProducer.toggleProcessing(true);
-    rightPathProducer.toggleProcessing(true);
+    auto overlapParam = apvts.getParameter(params.at(AnalyzerProperties::ParamNames::Analyzer_Overlap));
+    updateOverlap(overlapParam->convertFrom0to1(overlapParam->getValue()));
+    
+    auto multiResolutionParam = apvts.getParameter(params.at(AnalyzerProperties::ParamNames::Analyzer_Multi_Resolution));
+    updateMultiResolution(multiResolutionParam->getValue());
+    
+    auto averagingParam = apvts.getParameter(params.at(AnalyzerProperties::ParamNames::Analyzer_Averaging));
+    updateAveraging(averagingParam->convertFrom0to1(averagingParam->getValue()));
+    
+    auto averagingTimeParam = apvts.getParameter(params.at(AnalyzerProperties::ParamNames::Analyzer_Averaging_Time));
+    updateAveragingTime(averagingTimeParam->convertFrom0to1(averagingTimeParam->getValue()));
+    
+    auto smoothingParam = apvts.getParameter(params.at(AnalyzerProperties::ParamNames::Analyzer_Smoothing));
+    updateSmoothing(smoothingParam->convertFrom0to1(smoothingParam->getValue()));
+    
+    auto fillParam = apvts.getParameter(params.at(AnalyzerProperties::ParamNames::Analyzer_Fill));
+    updateFill(fillParam->getValue());
+    
+    pathProducer.toggleProcessing(true);
     
     addAndMakeVisible(analyzerScale);
     addAndMakeVisible(eqScale);
@@ -64,20 +103,20 @@ void SpectrumAnalyzer::timerCallback()
 {
     if (!active)
     {
-        leftAnalyzerPath.clear();
-        rightAnalyzerPath.clear();
+        releaseAnalyzerImage();
         stopTimer();
     }
     else
     {
-        if ( leftPathProducer.getNumAvailableForReading() > 0 )
-        {
-            while ( leftPathProducer.pull(leftAnalyzerPath) ) { } // get most recent
-        }
+        // dragged onto a display with a different scale
+        if ( getImageScale() != imageScale )
+            updateImageBounds();
         
-        if ( rightPathProducer.getNumAvailableForReading() > 0 )
+        auto latest = pathProducer.pullLatestImage();
+        if ( latest >= 0 )
         {
-            while ( rightPathProducer.pull(rightAnalyzerPath) ) { } // get most recent
+            releaseAnalyzerImage();
+            analyzerImage = latest;
         }
     }
     repaint();
@@ -86,8 +125,8 @@ void SpectrumAnalyzer::timerCallback()
 void SpectrumAnalyzer::resized()
 {
     AnalyzerBase::resized();
-    leftPathProducer.setFFTRectBounds(fftBoundingBox.toFloat());
-    rightPathProducer.setFFTRectBounds(fftBoundingBox.toFloat());
+    
+    updateImageBounds();
     
     auto textHeight = getTextHeight();
     auto textWidth = getTextWidth() * 1.5;
@@ -114,14 +153,49 @@ void SpectrumAnalyzer::paint(juce::Graphics& g)
     
     g.reduceClipRegion(fftBoundingBox);
     
-    leftAnalyzerPath.applyTransform(juce::AffineTransform().translation(fftBoundingBox.getX(), fftBoundingBox.getY() - getTextHeight()));
-    rightAnalyzerPath.applyTransform(juce::AffineTransform().translation(fftBoundingBox.getX(), fftBoundingBox.getY() - getTextHeight()));
+    // the traces were already drawn by the path producer, at the fft bounds' size in physical pixels
+    if ( analyzerImage >= 0 )
+    {
+        const auto& image = pathProducer.getImage(analyzerImage);
+        auto transform = juce::AffineTransform::scale(static_cast<float>(fftBoundingBox.getWidth()) / static_cast<float>(image.getWidth()),
+                                                      static_cast<float>(fftBoundingBox.getHeight()) / static_cast<float>(image.getHeight()))
+                                               .translated(fftBoundingBox.getPosition());
+        g.drawImageTransformed(image, transform);
+    }
+}
+
+void SpectrumAnalyzer::mouseDown(const juce::MouseEvent& e)
+{
+    // clicking the traces lets go of a peak hold (and starts any other averaging over)
+    if ( fftBoundingBox.contains(e.getPosition()) )
+        pathProducer.resetAveraging();
+}
+
+float SpectrumAnalyzer::getImageScale()
+{
+    auto scale = juce::Component::getApproximateScaleFactorForComponent(this);
     
-    g.setColour(ColourPalette::getColour(ColourPalette::Blue));
-    g.strokePath(leftAnalyzerPath, juce::PathStrokeType(1.f));
+    if ( auto* display = juce::Desktop::getInstance().getDisplays().getDisplayForRect(getScreenBounds()) )
+        scale *= static_cast<float>(display->scale);
     
-    g.setColour(ColourPalette::getColour(ColourPalette::MeterGreen));
-    g.strokePath(rightAnalyzerPath, juce::PathStrokeType(1.f));
+    return scale;
+}
+
+void SpectrumAnalyzer::updateImageBounds()
+{
+    imageScale = getImageScale();
+    
+    // every image is about to be remade at the new size
+    releaseAnalyzerImage();
+    pathProducer.setFFTRectBounds(fftBoundingBox.toFloat(), imageScale);
+}
+
+void SpectrumAnalyzer::releaseAnalyzerImage()
+{
+    if ( analyzerImage >= 0 )
+        pathProducer.releaseImage(analyzerImage);
+    
+    analyzerImage = -1;
 }
 
 void SpectrumAnalyzer::customizeScales(int lsMin, int lsMax, int rsMin, int rsMax, int division)
@@ -131,8 +205,7 @@ void SpectrumAnalyzer::customizeScales(int lsMin, int lsMax, int rsMin, int rsMa
     rightScaleMin = rsMin;
     rightScaleMax = rsMax;
     
-    leftPathProducer.changePathRange(leftScaleMin, leftScaleMax);
-    rightPathProducer.changePathRange(leftScaleMin, leftScaleMax);
+    pathProducer.changePathRange(leftScaleMin, leftScaleMax);
     
     analyzerScale.buildBackgroundImage(division, fftBoundingBox, leftScaleMin, leftScaleMax);
     eqScale.buildBackgroundImage(division, fftBoundingBox, leftScaleMin, leftScaleMax);
@@ -205,15 +278,47 @@ void SpectrumAnalyzer::setActive(bool activeState)
 
 void SpectrumAnalyzer::updateDecayRate(float decayRate)
 {
-    leftPathProducer.setDecayRate(decayRate);
-    rightPathProducer.setDecayRate(decayRate);
+    pathProducer.setDecayRate(decayRate);
 }
 
 void SpectrumAnalyzer::updateOrder(float value)
 {
     auto denormalizedVal = static_cast<int>(std::floor(juce::jmap<float>(value, 0.f, 1.f, 11.f, 13.f)));
-    leftPathProducer.changeOrder(static_cast<FFTOrder>(denormalizedVal));
-    rightPathProducer.changeOrder(static_cast<FFTOrder>(denormalizedVal));
+    pathProducer.changeOrder(static_cast<FFTOrder>(denormalizedVal));
+}
+
+void SpectrumAnalyzer::updateOverlap(float value)
+{
+    // the choice's index, ParamListener hands over the denormalised value
+    auto overlapParam = juce::jlimit(0, 2, juce::roundToInt(value));
+    pathProducer.setOverlap(static_cast<AnalyzerProperties::OverlapModes>(overlapParam));
+}
+
+void SpectrumAnalyzer::updateMultiResolution(float value)
+{
+    pathProducer.setMultiResolution(value > 0.5f);
+}
+
+void SpectrumAnalyzer::updateAveraging(float value)
+{
+    auto averagingParam = juce::jlimit(0, 4, juce::roundToInt(value));
+    pathProducer.setAveraging(static_cast<AnalyzerProperties::AveragingModes>(averagingParam));
+}
+
+void SpectrumAnalyzer::updateAveragingTime(float milliseconds)
+{
+    pathProducer.setAveragingTime(milliseconds);
+}
+
+void SpectrumAnalyzer::updateSmoothing(float value)
+{
+    auto smoothingParam = juce::jlimit(0, 5, juce::roundToInt(value));
+    pathProducer.setSmoothing(static_cast<AnalyzerProperties::SmoothingModes>(smoothingParam));
+}
+
+void SpectrumAnalyzer::updateFill(float value)
+{
+    pathProducer.setFillArea(value > 0.5f);
 }
 
 void SpectrumAnalyzer::animate()
@@ -15,41 +15,60 @@
 #include "PathProducer.h"
 #include "DbScale.h"
 #include "ParamListener.h"
-#include "../dsp/SingleChannelSampleFifo.h"
+#include "../dsp/AnalysisRing.h"
 #include "../Globals.h"
 
 //==============================================================================
 struct SpectrumAnalyzer : AnalyzerBase, juce::Timer
 {
     SpectrumAnalyzer(double _sampleRate,
-                     SingleChannelSampleFifo<juce::AudioBuffer<float>>& leftScsf,
-                     SingleChannelSampleFifo<juce::AudioBuffer<float>>& rightScsf,
+                     AnalysisRing& analysisRing,
                      juce::AudioProcessorValueTreeState& apvts);
     
     void timerCallback() override;
     void resized() override;
     void paint(juce::Graphics& g) override;
+    void mouseDown(const juce::MouseEvent& e) override;
     void customizeScales(int lsMin, int lsMax, int rsMin, int rsMax, int division);
 private:
     double sampleRate;
-    juce::Path leftAnalyzerPath, rightAnalyzerPath;
+    // the image being painted, held in the path producer's pool until a newer one replaces it. -1 for none
+    int analyzerImage { -1 };
     
-    PathProducer leftPathProducer, rightPathProducer;
+    PathProducer pathProducer;
     
     bool active { false };
     
+    // physical pixels per logical one where the analyzer is, what the trace images are drawn at
+    float imageScale { 1.f };
+    
     void paintBackground(juce::Graphics& g);
+    void releaseAnalyzerImage();
+    float getImageScale();
+    void updateImageBounds();
     
     void setActive(bool activeState);
     void updateDecayRate(float decayRate);
     void updateOrder(float value);
+    void updateOverlap(float value);
+    void updateMultiResolution(float value);
+    void updateAveraging(float value);
+    void updateAveragingTime(float milliseconds);
+    void updateSmoothing(float value);
+    void updateFill(float value);
     void animate();
     
     DbScale analyzerScale, eqScale;
     
     std::unique_ptr<ParamListener<float>> analyzerEnabledParamListener,
                                           analyzerDecayRateParamListener,
-                                          analyzerOrderParamListener;
+                                          analyzerOrderParamListener,
+                                          analyzerOverlapParamListener,
+                                          analyzerMultiResolutionParamListener,
+                                          analyzerAveragingParamListener,
+                                          analyzerAveragingTimeParamListener,
+                                          analyzerSmoothingParamListener,
+                                          analyzerFillParamListener;
     
     float leftScaleMin  {Globals::getNegativeInf()},
           leftScaleMax  {Globals::getMaxDecibels()},
@@ -0,0 +1,86 @@
+/*
+  ==============================================================================
+  
+    SpectrumRasterizer.cpp
+    Created: 19 Oct 2026 5:11:40am
+    Author:  Matt Aiken
+  
+  ==============================================================================
+*/
+
+#include "SpectrumRasterizer.h"
+
+//==============================================================================
+void SpectrumRasterizer::clear(juce::Image::BitmapData& bitmap)
+{
+    for ( auto y = 0; y < bitmap.height; ++y )
+    {
+        std::memset(bitmap.getLinePointer(y), 0, static_cast<size_t>(bitmap.width * bitmap.pixelStride));
+    }
+}
+
+void SpectrumRasterizer::drawTrace(juce::Image::BitmapData& bitmap,
+                                   const std::vector<float>& columnPositions,
+                                   juce::Colour lineColour,
+                                   juce::Colour fillColour,
+                                   float lineThickness)
+{
+    jassert( bitmap.pixelFormat == juce::Image::ARGB );
+    
+    auto numColumns = juce::jmin(bitmap.width, static_cast<int>(columnPositions.size()));
+    if ( numColumns <= 0 )
+        return;
+    
+    const auto height = static_cast<float>(bitmap.height);
+    const auto halfThickness = lineThickness * 0.5f;
+    const auto drawFill = !fillColour.isTransparent();
+    
+    // premultiplied, as the image stores them
+    const auto line = lineColour.getPixelARGB();
+    const auto fill = fillColour.getPixelARGB();
+    
+    auto blend = [&bitmap](int x, int y, juce::PixelARGB colour, float coverage)
+    {
+        if ( coverage < 1.f )
+            colour.multiplyAlpha(coverage);
+        
+        reinterpret_cast<juce::PixelARGB*>(bitmap.getPixelPointer(x, y))->blend(colour);
+    };
+    
+    // how much of row y the span [top, bottom) covers
+    auto coverageOf = [](int y, float top, float bottom)
+    {
+        return juce::jlimit(0.f, 1.f, juce::jmin(bottom, static_cast<float>(y + 1)) - juce::jmax(top, static_cast<float>(y)));
+    };
+    
+    for ( auto x = 0; x < numColumns; ++x )
+    {
+        auto y = juce::jlimit(0.f, height, columnPositions[static_cast<size_t>(x)]);
+        auto left = juce::jlimit(0.f, height, columnPositions[static_cast<size_t>(juce::jmax(x - 1, 0))]);
+        auto right = juce::jlimit(0.f, height, columnPositions[static_cast<size_t>(juce::jmin(x + 1, numColumns - 1))]);
+        
+        auto top = juce::jmin(y, (y + left) * 0.5f, (y + right) * 0.5f) - halfThickness;
+        auto bottom = juce::jmax(y, (y + left) * 0.5f, (y + right) * 0.5f) + halfThickness;
+        
+        if ( drawFill )
+        {
+            // under the line only, the line is drawn over its top
+            auto firstRow = static_cast<int>(y);
+            if ( firstRow < bitmap.height )
+                blend(x, firstRow, fill, coverageOf(firstRow, y, height));
+            
+            for ( auto row = firstRow + 1; row < bitmap.height; ++row )
+            {
+                reinterpret_cast<juce::PixelARGB*>(bitmap.getPixelPointer(x, row))->blend(fill);
+            }
+        }
+        
+        auto firstRow = juce::jmax(0, static_cast<int>(std::floor(top)));
+        auto endRow = juce::jmin(bitmap.height, static_cast<int>(std::ceil(bottom)));
+        
+        for ( auto row = firstRow; row < endRow; ++row )
+        {
+            blend(x, row, line, coverageOf(row, top, bottom));
+        }
+    }
+}
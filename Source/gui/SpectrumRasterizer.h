@@ -0,0 +1,39 @@
+/*
+  ==============================================================================
+  
+    SpectrumRasterizer.h
+    Created: 19 Oct 2026 5:11:40am
+    Author:  Matt Aiken
+  
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+Draws analyzer traces straight into an image's pixels, one vertical span per pixel column, instead of stroking a path.
+
+A trace is a y per column (see AnalyzerPathGenerator::getColumnPositions()). Each column's span runs from half way to
+the column on its left to half way to the one on its right, so neighbouring spans meet and steep slopes stay joined up,
+and it's thickened by the line width. The rows the span only partly covers are blended by how much of them it covers,
+which is all the anti-aliasing a line that's never more than one column wide needs. The optional fill runs from the
+line down to the bottom of the image.
+
+Each trace writes every pixel at most twice (fill, then line), and there's no path flattening or edge table, so it can
+run on the analyzer's thread at the frame rate and leave paint() with nothing to do but draw the image.
+*/
+struct SpectrumRasterizer
+{
+    // transparent, ready for the traces
+    static void clear(juce::Image::BitmapData& bitmap);
+    
+    // fillColour can be transparent for no fill. the image has to be ARGB
+    static void drawTrace(juce::Image::BitmapData& bitmap,
+                          const std::vector<float>& columnPositions,
+                          juce::Colour lineColour,
+                          juce::Colour fillColour,
+                          float lineThickness = 1.f);
+};
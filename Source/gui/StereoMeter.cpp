@@ -10,6 +10,7 @@
 
 #include "StereoMeter.h"
 #include "../Globals.h"
+#include "../ColourPalette.h"
 
 //==============================================================================
 StereoMeter::StereoMeter()
@@ -19,9 +20,43 @@ StereoMeter::StereoMeter()
     addAndMakeVisible(dbScale);
 }
 
+void StereoMeter::paint(juce::Graphics& g)
+{
+    auto formatLufs = [](float value)
+    {
+        return value <= Globals::getNegativeInf() ? juce::String("-inf") : juce::String(value, 1);
+    };
+    
+    const juce::String lines[numLoudnessLines]
+    {
+        "M "   + formatLufs(loudness.momentaryLufs),
+        "S "   + formatLufs(loudness.shortTermLufs),
+        "I "   + formatLufs(loudness.integratedLufs),
+        "LRA " + juce::String(loudness.loudnessRangeLu, 1)
+    };
+    
+    g.setColour(ColourPalette::getColour(ColourPalette::Text));
+    
+    auto lineHeight = loudnessBounds.getHeight() / numLoudnessLines;
+    for ( auto i = 0; i < numLoudnessLines; ++i )
+    {
+        g.drawFittedText(lines[i],
+                         loudnessBounds.getX(),
+                         loudnessBounds.getY() + lineHeight * i,
+                         loudnessBounds.getWidth(),
+                         lineHeight,
+                         juce::Justification::centred,
+                         1);
+    }
+}
+
 void StereoMeter::resized()
 {
     auto bounds = getLocalBounds();
+    
+    // loudness readout lives in a strip under the meters
+    loudnessBounds = bounds.removeFromBottom(bounds.getHeight() / 6);
+    
     auto padding = bounds.getHeight() / 20;
     auto widthUnit = bounds.getWidth() / 7;
     
@@ -49,8 +84,17 @@ void StereoMeter::resized()
     dbScale.buildBackgroundImage(6, meterBoundsForDbScale, Globals::getNegativeInf(), Globals::getMaxDecibels());
 }
 
+void StereoMeter::mouseDown(const juce::MouseEvent& e)
+{
+    if ( loudnessBounds.contains(e.getPosition()) && onLoudnessReset )
+        onLoudnessReset();
+}
+
 void StereoMeter::update(const MeterValues& meterValues)
 {
-    meterL.update(meterValues.leftPeakDb.getDb(), meterValues.leftRmsDb.getDb());
-    meterR.update(meterValues.rightPeakDb.getDb(), meterValues.rightRmsDb.getDb());
+    meterL.update(meterValues.leftPeakDb.getDb(), meterValues.leftRmsDb.getDb(), meterValues.leftTruePeakDb.getDb());
+    meterR.update(meterValues.rightPeakDb.getDb(), meterValues.rightRmsDb.getDb(), meterValues.rightTruePeakDb.getDb());
+    
+    loudness = meterValues.loudness;
+    repaint(loudnessBounds);
 }
@@ -19,9 +19,19 @@
 struct StereoMeter : juce::Component
 {
     StereoMeter();
+    void paint(juce::Graphics& g) override;
     void resized() override;
+    void mouseDown(const juce::MouseEvent& e) override;
     void update(const MeterValues& meterValues);
+    
+    // called when the loudness readout is clicked
+    std::function<void()> onLoudnessReset;
 private:
     Meter meterL{"L", 95.f}, meterR{"R", 95.f};
     DbScale dbScale;
+    
+    LoudnessValues loudness;
+    juce::Rectangle<int> loudnessBounds;
+    
+    static constexpr int numLoudnessLines = 4;
 };
@@ -34,12 +34,18 @@ void TriMeter::paint(juce::Graphics& g)
     auto outMeter = juce::Rectangle<int>(meterWidth, outDbScaled, meterWidth, meterHeight - outDbScaled);
     g.fillRect(outMeter);
 
-    // gain reduction
-    auto gainReduction = std::floor(juce::jmap<float>(outValueDb - inValueDb, Globals::getNegativeInf(), Globals::getMaxDecibels(), meterHeight, 0));
+    // gain reduction, straight from the compressor: the bar is the block's average, the line its deepest point
+    auto gainReduction = std::floor(juce::jmap<float>(meanGainReductionDb, Globals::getNegativeInf(), Globals::getMaxDecibels(), meterHeight, 0));
     auto grMeter = juce::Rectangle<int>(meterWidth * 2, 0, meterWidth, gainReduction);
     grMeter.removeFromTop(zeroDbTick.y);
     g.fillRect(grMeter);
     
+    if ( maxGainReductionDb < 0.f )
+    {
+        auto maxGainReduction = std::floor(juce::jmap<float>(maxGainReductionDb, Globals::getNegativeInf(), Globals::getMaxDecibels(), meterHeight, 0));
+        g.fillRect(meterWidth * 2, static_cast<int>(maxGainReduction) - 1, meterWidth, 2);
+    }
+    
     // ticks
     for ( auto i = 0; i < 3; ++i )
     {
@@ -94,10 +100,12 @@ void TriMeter::resized()
     ticks = getTicks(6);
 }
 
-void TriMeter::update(const float& inDb, const float& outDb)
+void TriMeter::update(const float& inDb, const float& outDb, const float& meanGrDb, const float& maxGrDb)
 {
     inValueDb = inDb;
     outValueDb = outDb;
+    meanGainReductionDb = meanGrDb;
+    maxGainReductionDb = maxGrDb;
     repaint();
 }
 
@@ -19,12 +19,13 @@ struct TriMeter : juce::Component
 {
     void paint(juce::Graphics& g) override;
     void resized() override;
-    void update(const float& inDb, const float& outDb);
+    void update(const float& inDb, const float& outDb, const float& meanGrDb, const float& maxGrDb);
     
     std::vector<Tick> getTicks(int dbDivision);
 private:
     juce::Rectangle<int> getMeterBounds();
     float inValueDb { Globals::getNegativeInf() }, outValueDb { Globals::getNegativeInf() };
+    float meanGainReductionDb { 0.f }, maxGainReductionDb { 0.f };
     std::vector<Tick> ticks;
     Tick zeroDbTick;
 };